@@ -0,0 +1,502 @@
+/*
+    g++ -O2 alt_search.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 2 0
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    reverse shortest path: 0 3 4 has length: 0.783333
+    settled vertices: 4 (dijkstra: 6)
+    6 landmarks, 288 bytes, built in ... ms
+
+Notes:
+ALT: A*, landmarks and the triangle inequality (Goldberg & Harrelson,
+"Computing the Shortest Path: A* Search Meets Graph Theory", SODA 2005)
+preprocessing picks k landmarks and stores every vertex's distance to
+and from each of them
+for any landmark L, d(v,t) >= d(v,L) - d(t,L) and d(v,t) >= d(L,t) -
+d(L,v); the largest of these bounds is an admissible, consistent A*
+potential, which steers the search toward t
+landmarks are picked farthest-first: each new landmark is the vertex
+farthest from those already chosen, so they end up on the fringes of
+the graph, where the bounds are tightest
+
+ */
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <chrono>
+
+// Adjacency list graph representation
+typedef unsigned vertex_id;
+typedef float edge_weight;
+typedef std::map<vertex_id, edge_weight> neighbors_t;
+typedef std::vector<neighbors_t> graph;
+
+// Add a vertex to g and return its id
+// Complexity: O( 1 )
+inline vertex_id add_vertex( graph& g )
+{
+    vertex_id v = g.size();
+    g.resize( v + 1 );
+    return v;
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( graph const& g )
+{
+    return g.size();
+}
+
+// Return the number of outgoing edges from u in g
+inline std::size_t count_adj( graph const& g, vertex_id u )
+{
+    return g[u].size();
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(|V|) )
+inline bool has_edge(graph const& g, int u, int v)
+{
+    return g[u].find(v) != g[u].end();
+}
+
+// Add an edge in g from u to v with weight w
+// Complexity: O( log(|V|) )
+// Requires: u is a vertex in g, i.e. u < count_vertices( g )
+inline void add_edge( graph& g, vertex_id u, vertex_id v, edge_weight w )
+{
+    assert( u < count_vertices( g ) );
+    g[u].insert( std::make_pair( v, w ) );
+}
+
+// Return a reverse index of g: a graph with an edge from v to u of
+// weight w for every edge from u to v of weight w in g.
+// Complexity: O( |V| + |E| )
+graph transposed_graph( graph const& g )
+{
+    graph result( count_vertices( g ) );
+    for ( vertex_id u = 0, n = count_vertices( g ); u != n; ++u )
+    {
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+        {
+            if ( p->first >= result.size() )
+                result.resize( p->first + 1 );
+            result[p->first].insert( result[p->first].end(), std::make_pair( u, p->second ) );
+        }
+    }
+    return result;
+}
+
+// A d-ary min-heap of vertices keyed by edge_weight, holding each
+// vertex at most once.  Vertices must be less than the n given to the
+// constructor.
+template <unsigned Arity = 4>
+class indexed_heap
+{
+ public:
+    explicit indexed_heap( std::size_t n ) : position_( n, npos ) {}
+
+    bool empty() const { return heap_.empty(); }
+
+    std::size_t size() const { return heap_.size(); }
+
+    // True iff v is in the heap
+    bool contains( vertex_id v ) const { return position_[v] != npos; }
+
+    // The vertex with the least key, and its key
+    // Requires: !empty()
+    vertex_id top() const { return heap_[0].v; }
+    edge_weight top_key() const { return heap_[0].key; }
+
+    // Insert v with key k, or lower v's key to k if v is already in
+    // the heap with a greater key.  Return true iff the heap changed.
+    // Complexity: O( log(n) / log(Arity) )
+    bool push_or_decrease( vertex_id v, edge_weight k )
+    {
+        unsigned i = position_[v];
+        if ( i == npos )
+        {
+            i = heap_.size();
+            heap_.push_back( entry( k, v ) );
+        }
+        else if ( !(k < heap_[i].key) )
+            return false;
+
+        sift_up( i, entry( k, v ) );
+        return true;
+    }
+
+    // Remove and return the vertex with the least key
+    // Requires: !empty()
+    // Complexity: O( Arity x log(n) / log(Arity) )
+    vertex_id pop()
+    {
+        vertex_id v = heap_[0].v;
+        position_[v] = npos;
+        entry last = heap_.back();
+        heap_.pop_back();
+        if ( !heap_.empty() )
+            sift_down( 0, last );
+        return v;
+    }
+
+ private:
+    static unsigned const npos = unsigned( -1 );
+
+    struct entry
+    {
+        entry() {}
+        entry( edge_weight k, vertex_id u ) : key( k ), v( u ) {}
+        edge_weight key;
+        vertex_id v;
+    };
+
+    void place( unsigned i, entry const& e )
+    {
+        heap_[i] = e;
+        position_[e.v] = i;
+    }
+
+    // Put e at slot i or above, moving greater ancestors down
+    void sift_up( unsigned i, entry const& e )
+    {
+        while ( i > 0 )
+        {
+            unsigned parent = (i - 1) / Arity;
+            if ( !(e.key < heap_[parent].key) )
+                break;
+            place( i, heap_[parent] );
+            i = parent;
+        }
+        place( i, e );
+    }
+
+    // Put e at slot i or below, moving lesser children up
+    void sift_down( unsigned i, entry const& e )
+    {
+        for ( unsigned first; (first = i * Arity + 1) < heap_.size(); )
+        {
+            unsigned last = std::min<std::size_t>( first + Arity, heap_.size() ), least = first;
+            for ( unsigned c = first + 1; c < last; ++c )
+                if ( heap_[c].key < heap_[least].key )
+                    least = c;
+            if ( !(heap_[least].key < e.key) )
+                break;
+            place( i, heap_[least] );
+            i = least;
+        }
+        place( i, e );
+    }
+
+    std::vector<entry> heap_;
+    std::vector<unsigned> position_;
+};
+
+template <unsigned Arity>
+unsigned const indexed_heap<Arity>::npos;
+
+edge_weight const infinity = std::numeric_limits<edge_weight>::infinity();
+
+// Return the length of the shortest path from s to every vertex of g,
+// or infinity for vertices s cannot reach
+// Complexity: O( (|V| + |E|) log(|V|) )
+// Requires: s is a vertex in g
+std::vector<edge_weight> shortest_distances( graph const& g, vertex_id s )
+{
+    assert( s < count_vertices( g ) );
+    std::vector<edge_weight> d( count_vertices( g ), infinity );
+    indexed_heap<> q( count_vertices( g ) );
+    d[s] = 0;
+    q.push_or_decrease( s, 0 );
+    while ( !q.empty() )
+    {
+        vertex_id const u = q.pop();
+        for ( neighbors_t::const_iterator adj = g[u].begin(), last = g[u].end(); adj != last; ++adj )
+        {
+            edge_weight x = d[u] + adj->second;
+            if ( x < d[adj->first] )
+            {
+                d[adj->first] = x;
+                q.push_or_decrease( adj->first, x );
+            }
+        }
+    }
+    return d;
+}
+
+// Landmarks of a graph and every vertex's distances to and from them.
+// from[v * k + i] is the distance from landmarks[i] to v, and
+// to[v * k + i] the distance from v to landmarks[i], where k is the
+// number of landmarks; each vertex's bounds are contiguous.
+struct landmark_index
+{
+    std::vector<vertex_id> landmarks;
+    std::vector<edge_weight> from;
+    std::vector<edge_weight> to;
+};
+
+// Pick up to k landmarks of g farthest-first and compute their
+// distances.  The first landmark is the vertex farthest from start;
+// each later one is the vertex whose nearest landmark is farthest
+// away, with vertices no landmark reaches counted as farthest of all.
+// An empty graph, or k of 0, gets no landmarks.
+// Complexity: O( k x (|V| + |E|) log(|V|) )
+// Requires: start is a vertex in g, unless there are no landmarks
+landmark_index make_landmark_index( graph const& g, unsigned k, vertex_id start = 0 )
+{
+    std::size_t const n = count_vertices( g );
+    k = std::min<std::size_t>( k, n );
+
+    landmark_index x;
+    if ( k == 0 )
+        return x;
+    assert( start < n );
+    graph const rg = transposed_graph( g );
+    std::vector<std::vector<edge_weight> > from, to;
+
+    // nearest[v] is the distance to v from the nearest landmark so far
+    std::vector<edge_weight> nearest = shortest_distances( g, start );
+    while ( x.landmarks.size() < k )
+    {
+        vertex_id best = 0;
+        for ( vertex_id v = 1; v < n; ++v )
+            if ( nearest[v] > nearest[best] )
+                best = v;
+        if ( !x.landmarks.empty() && nearest[best] == 0 )
+            break;   // every vertex is already a landmark or free to reach
+
+        x.landmarks.push_back( best );
+        from.push_back( shortest_distances( g, best ) );
+        to.push_back( shortest_distances( rg, best ) );
+        if ( x.landmarks.size() == 1 )
+            nearest = from.back();
+        else
+            for ( vertex_id v = 0; v < n; ++v )
+                nearest[v] = std::min( nearest[v], from.back()[v] );
+    }
+
+    k = x.landmarks.size();
+    x.from.resize( n * k );
+    x.to.resize( n * k );
+    for ( vertex_id v = 0; v < n; ++v )
+    {
+        for ( unsigned i = 0; i < k; ++i )
+        {
+            x.from[v * k + i] = from[i][v];
+            x.to[v * k + i] = to[i][v];
+        }
+    }
+    return x;
+}
+
+// Return the number of bytes of distances x holds
+inline std::size_t memory_bytes( landmark_index const& x )
+{
+    return (x.from.size() + x.to.size()) * sizeof( edge_weight );
+}
+
+// Return a lower bound on the distance from v to t, from the triangle
+// inequality at every landmark of x; infinity means t is unreachable
+// from v.
+edge_weight landmark_bound( landmark_index const& x, vertex_id v, vertex_id t )
+{
+    std::size_t const k = x.landmarks.size();
+    edge_weight const* from_v = x.from.data() + v * k;
+    edge_weight const* from_t = x.from.data() + t * k;
+    edge_weight const* to_v = x.to.data() + v * k;
+    edge_weight const* to_t = x.to.data() + t * k;
+
+    edge_weight bound = 0;
+    for ( std::size_t i = 0; i < k; ++i )
+    {
+        // t reaches L but v does not: v cannot reach t
+        if ( to_v[i] == infinity && to_t[i] != infinity )
+            return infinity;
+        if ( to_t[i] != infinity )
+            bound = std::max( bound, to_v[i] - to_t[i] );
+        if ( from_v[i] != infinity )
+            bound = std::max( bound, from_t[i] - from_v[i] );
+    }
+    return bound;
+}
+
+// An A* potential that is always zero, turning A* into Dijkstra
+struct zero_potential
+{
+    edge_weight operator()( vertex_id ) const { return 0; }
+};
+
+// The ALT potential for queries toward t
+struct landmark_potential
+{
+    landmark_potential( landmark_index const& x_, vertex_id t_ ) : x( &x_ ), t( t_ ) {}
+    edge_weight operator()( vertex_id v ) const { return landmark_bound( *x, v, t ); }
+
+    landmark_index const* x;
+    vertex_id t;
+};
+
+// Compute the shortest path from s to dst by A* search with potential
+// h, a consistent lower bound on each vertex's distance to dst.  The
+// path is written as by poor_dijkstra: the ids of vertices on the path
+// (excluding s), in reverse order, into out_path; the result is the
+// total path cost and the resulting value of out_path, or infinity and
+// out_path untouched if dst is unreachable.  settled is set to the
+// number of vertices taken off the queue.
+template <class Potential, class OutputIterator>
+std::pair<edge_weight,OutputIterator>
+astar( graph const& g, vertex_id s, vertex_id dst, Potential h, OutputIterator out_path,
+       std::size_t& settled )
+{
+    std::size_t const n = count_vertices( g );
+    assert( s < n && dst < n );
+
+    std::vector<edge_weight> d( n, infinity );
+    std::vector<vertex_id> p( n );
+    for ( vertex_id u = 0; u < n; ++u )
+        p[u] = u;
+
+    // Each vertex's potential, computed when the search first reaches it
+    std::vector<edge_weight> potential( n, -1 );
+    potential[s] = h( s );
+
+    indexed_heap<> q( n );
+    d[s] = 0;
+    if ( potential[s] != infinity )
+        q.push_or_decrease( s, potential[s] );
+
+    for ( settled = 0; !q.empty(); )
+    {
+        vertex_id const u = q.pop();
+        ++settled;
+        if ( u == dst )
+            break;
+
+        for ( neighbors_t::const_iterator adj = g[u].begin(), last = g[u].end(); adj != last; ++adj )
+        {
+            vertex_id const v = adj->first;
+            edge_weight const x = d[u] + adj->second;
+            if ( !(x < d[v]) )
+                continue;
+            if ( potential[v] < 0 )
+                potential[v] = h( v );
+            if ( potential[v] == infinity )
+                continue;   // dst is unreachable from v
+
+            d[v] = x;
+            p[v] = u;
+            q.push_or_decrease( v, x + potential[v] );
+        }
+    }
+
+    edge_weight w = d[dst];
+    while ( p[dst] != dst )
+    {
+        *out_path++ = dst;
+        dst = p[dst];
+    }
+    return std::make_pair( w, out_path );
+}
+
+// Compute the shortest path from s to dst by A* search guided by the
+// landmarks in x, with the same result as poor_dijkstra.  settled is
+// set to the number of vertices the search settled.
+// Complexity: O( k x (|V| + |E|) log(|V|) ) in the worst case, for k
+// landmarks, but on graphs with good landmarks the search stays close
+// to the shortest path.
+template <class OutputIterator>
+std::pair<edge_weight,OutputIterator>
+alt_dijkstra( graph const& g, landmark_index const& x, vertex_id s, vertex_id dst,
+              OutputIterator out_path, std::size_t& settled )
+{
+    return astar( g, s, dst, landmark_potential( x, dst ), out_path, settled );
+}
+
+template <class OutputIterator>
+std::pair<edge_weight,OutputIterator>
+alt_dijkstra( graph const& g, landmark_index const& x, vertex_id s, vertex_id dst,
+              OutputIterator out_path )
+{
+    std::size_t settled;
+    return alt_dijkstra( g, x, s, dst, out_path, settled );
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = add_vertex( g );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + count_adj(g, src)) * 1.0 / count_vertices(g);
+            add_edge( g, src, dst, w );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << '\n';
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    graph g;
+
+    read_adjacency_list( std::cin, g );
+    write_adjacency_matrix( std::cout, g );
+
+    if ( argc >= 3 )
+    {
+        vertex_id u, v;
+        std::stringstream(argv[1]) >> u;
+        std::stringstream(argv[2]) >> v;
+
+        unsigned k = 8;
+        if ( argc == 4 )
+            std::stringstream(argv[3]) >> k;
+
+        typedef std::chrono::steady_clock clock;
+        clock::time_point start = clock::now();
+        landmark_index x = make_landmark_index( g, k );
+        double build_ms = std::chrono::duration<double, std::milli>( clock::now() - start ).count();
+
+        std::size_t settled, plain;
+        std::cout << "reverse shortest path: ";
+        edge_weight w = alt_dijkstra(
+            g, x, u, v, std::ostream_iterator<vertex_id>( std::cout, " " ), settled ).first;
+        std::cout << "has length: " << w << std::endl;
+
+        std::vector<vertex_id> path;
+        astar( g, u, v, zero_potential(), std::back_inserter( path ), plain );
+        std::cout << "settled vertices: " << settled << " (dijkstra: " << plain << ")" << std::endl;
+        std::cout << x.landmarks.size() << " landmarks, " << memory_bytes( x ) << " bytes, built in "
+                  << build_ms << " ms" << std::endl;
+    }
+}
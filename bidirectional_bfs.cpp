@@ -0,0 +1,277 @@
+/*
+    g++ -O2 bidirectional_bfs.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 2 0
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    vertex 0 is reachable from vertex 2 in 2 steps
+    vertices touched: 6 (one-directional bfs: 6)
+
+Notes:
+one search runs forward from the source over g, the other backward
+from the target over the transposed graph
+each round expands one whole level of whichever frontier is smaller
+the searches meet when an edge leads into a vertex the other search
+has seen; once a level produces a meeting, the shortest one is the
+answer
+
+ */
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <deque>
+#include <algorithm>
+#include <limits>
+#include <map>
+
+// Adjacency list graph representation
+typedef unsigned vertex_id;
+typedef float edge_weight;
+typedef std::map<vertex_id, edge_weight> neighbors_t;
+typedef std::vector<neighbors_t> graph;
+
+// Add a vertex to g and return its id
+// Complexity: O( 1 )
+inline vertex_id add_vertex( graph& g )
+{
+    vertex_id v = g.size();
+    g.resize( v + 1 );
+    return v;
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( graph const& g )
+{
+    return g.size();
+}
+
+// Return the number of outgoing edges from u in g
+inline std::size_t count_adj( graph const& g, vertex_id u )
+{
+    return g[u].size();
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(|V|) )
+inline bool has_edge(graph const& g, int u, int v)
+{
+    return g[u].find(v) != g[u].end();
+}
+
+// Add an edge in g from u to v with weight w
+// Complexity: O( log(|V|) )
+// Requires: u is a vertex in g, i.e. u < count_vertices( g )
+inline void add_edge( graph& g, vertex_id u, vertex_id v, edge_weight w )
+{
+    assert( u < count_vertices( g ) );
+    g[u].insert( std::make_pair( v, w ) );
+}
+
+// Return a reverse index of g: a graph with an edge from v to u of
+// weight w for every edge from u to v of weight w in g.
+// Complexity: O( |V| + |E| )
+graph transposed_graph( graph const& g )
+{
+    graph result( count_vertices( g ) );
+    for ( vertex_id u = 0, n = count_vertices( g ); u != n; ++u )
+    {
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+        {
+            if ( p->first >= result.size() )
+                result.resize( p->first + 1 );
+            result[p->first].insert( result[p->first].end(), std::make_pair( u, p->second ) );
+        }
+    }
+    return result;
+}
+
+// The hop count given to vertices a search has not reached
+unsigned const unreached = std::numeric_limits<unsigned>::max();
+
+// The answer to a point-to-point reachability query
+struct hop_distance
+{
+    // True iff the target is reachable from the source
+    bool reachable;
+
+    // The number of edges on a shortest path, if reachable
+    unsigned distance;
+
+    // The number of distinct vertices either search reached
+    std::size_t vertices_touched;
+};
+
+// One direction of a bidirectional search: the graph it walks, the
+// hop count of each vertex from its starting point, and its frontier
+struct search_side
+{
+    graph const* g;
+    std::vector<unsigned> hops;
+    std::vector<vertex_id> frontier;
+};
+
+// Expand every vertex on the frontier of near by one edge.  Return
+// the length of the shortest path through any edge that lands on a
+// vertex far has reached, or unreached if there is none.
+unsigned expand_level( search_side& near, search_side const& far, std::size_t& touched )
+{
+    unsigned best = unreached;
+    std::vector<vertex_id> next;
+    for ( std::size_t i = 0; i < near.frontier.size(); ++i )
+    {
+        vertex_id x = near.frontier[i];
+        graph const& g = *near.g;
+        for ( neighbors_t::const_iterator p = g[x].begin(), e = g[x].end(); p != e; ++p )
+        {
+            vertex_id y = p->first;
+            if ( far.hops[y] != unreached )
+                best = std::min( best, near.hops[x] + 1 + far.hops[y] );
+            if ( near.hops[y] == unreached )
+            {
+                if ( far.hops[y] == unreached )
+                    ++touched;
+                near.hops[y] = near.hops[x] + 1;
+                next.push_back( y );
+            }
+        }
+    }
+    near.frontier.swap( next );
+    return best;
+}
+
+// Return whether v is reachable from u in g, and in how many steps,
+// by searching forward from u in g and backward from v in rg until
+// the searches meet.  rg must be transposed_graph( g ).
+//
+// Complexity: O(|V|+|E|) in the worst case, but on graphs where the
+// search space grows quickly with distance, each search only needs to
+// go about half the distance.
+hop_distance bidirectional_bfs( graph const& g, graph const& rg, vertex_id u, vertex_id v )
+{
+    std::size_t const n = count_vertices( g );
+    assert( count_vertices( rg ) >= n && u < n && v < n );
+
+    hop_distance result = { true, 0, 1 };
+    if ( u == v )
+        return result;
+
+    search_side forward = { &g, std::vector<unsigned>( n, unreached ), std::vector<vertex_id>( 1, u ) };
+    search_side backward = { &rg, std::vector<unsigned>( n, unreached ), std::vector<vertex_id>( 1, v ) };
+    forward.hops[u] = 0;
+    backward.hops[v] = 0;
+    result.vertices_touched = 2;
+
+    while ( !forward.frontier.empty() && !backward.frontier.empty() )
+    {
+        unsigned best = forward.frontier.size() <= backward.frontier.size()
+            ? expand_level( forward, backward, result.vertices_touched )
+            : expand_level( backward, forward, result.vertices_touched );
+
+        if ( best != unreached )
+        {
+            result.distance = best;
+            return result;
+        }
+    }
+    result.reachable = false;
+    return result;
+}
+
+// A simple breadth-first search starting from u for vertex v.
+// Returns true iff v is reachable from u, and sets touched to the
+// number of vertices reached before v was found.
+// Complexity: O(|V|+|E|)
+bool bfs( graph const& g, vertex_id u, vertex_id v, std::size_t& touched )
+{
+    std::vector<bool> visited( count_vertices( g ) );
+    std::deque<vertex_id> q( 1, u );
+    visited[u] = true;
+    touched = 1;
+
+    while ( !q.empty() )
+    {
+        vertex_id const next = q.front();
+        q.pop_front();
+        if ( next == v )
+            return true;
+
+        for ( neighbors_t::const_iterator p = g[next].begin(), e = g[next].end(); p != e; ++p )
+        {
+            if ( !visited[p->first] )
+            {
+                visited[p->first] = true;
+                ++touched;
+                q.push_back( p->first );
+            }
+        }
+    }
+    return false;
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = add_vertex( g );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + count_adj(g, src)) * 1.0 / count_vertices(g);
+            add_edge( g, src, dst, w );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << '\n';
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    graph g;
+
+    read_adjacency_list( std::cin, g );
+    write_adjacency_matrix( std::cout, g );
+
+    if ( argc == 3 )
+    {
+        vertex_id u, v;
+        std::stringstream(argv[1]) >> u;
+        std::stringstream(argv[2]) >> v;
+
+        hop_distance d = bidirectional_bfs( g, transposed_graph( g ), u, v );
+        std::cout << "vertex " << v << " is ";
+        if ( d.reachable )
+            std::cout << "reachable from vertex " << u << " in " << d.distance << " steps";
+        else
+            std::cout << "not reachable from vertex " << u;
+        std::cout << std::endl;
+
+        std::size_t touched;
+        bfs( g, u, v, touched );
+        std::cout << "vertices touched: " << d.vertices_touched
+                  << " (one-directional bfs: " << touched << ")" << std::endl;
+    }
+}
@@ -0,0 +1,398 @@
+/*
+    g++ -O2 bidirectional_dijkstra.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 2 0
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    reverse shortest path: 0 3 4 has length: 0.783333
+    settled vertices: 4 (one-directional dijkstra: 6)
+
+Notes:
+one Dijkstra search grows forward from the source over g, the other
+backward from the target over the transposed graph; each step settles
+a vertex on whichever side has the nearer queue head
+mu is the length of the shortest s-t path seen so far through an edge
+joining the two searches
+once the two queue heads together are at least mu, no unseen path can
+be shorter, so mu is the answer
+on graphs where the ball of radius r holds about r^2 vertices, two
+balls of radius r/2 hold about half as many
+
+ */
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+#include <map>
+
+// Adjacency list graph representation
+typedef unsigned vertex_id;
+typedef float edge_weight;
+typedef std::map<vertex_id, edge_weight> neighbors_t;
+typedef std::vector<neighbors_t> graph;
+
+// Add a vertex to g and return its id
+// Complexity: O( 1 )
+inline vertex_id add_vertex( graph& g )
+{
+    vertex_id v = g.size();
+    g.resize( v + 1 );
+    return v;
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( graph const& g )
+{
+    return g.size();
+}
+
+// Return the number of outgoing edges from u in g
+inline std::size_t count_adj( graph const& g, vertex_id u )
+{
+    return g[u].size();
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(|V|) )
+inline bool has_edge(graph const& g, int u, int v)
+{
+    return g[u].find(v) != g[u].end();
+}
+
+// Add an edge in g from u to v with weight w
+// Complexity: O( log(|V|) )
+// Requires: u is a vertex in g, i.e. u < count_vertices( g )
+inline void add_edge( graph& g, vertex_id u, vertex_id v, edge_weight w )
+{
+    assert( u < count_vertices( g ) );
+    g[u].insert( std::make_pair( v, w ) );
+}
+
+// Return a reverse index of g: a graph with an edge from v to u of
+// weight w for every edge from u to v of weight w in g.
+// Complexity: O( |V| + |E| )
+graph transposed_graph( graph const& g )
+{
+    graph result( count_vertices( g ) );
+    for ( vertex_id u = 0, n = count_vertices( g ); u != n; ++u )
+    {
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+        {
+            if ( p->first >= result.size() )
+                result.resize( p->first + 1 );
+            result[p->first].insert( result[p->first].end(), std::make_pair( u, p->second ) );
+        }
+    }
+    return result;
+}
+
+// A d-ary min-heap of vertices keyed by edge_weight, holding each
+// vertex at most once.  Vertices must be less than the n given to the
+// constructor.
+template <unsigned Arity = 4>
+class indexed_heap
+{
+ public:
+    explicit indexed_heap( std::size_t n ) : position_( n, npos ) {}
+
+    bool empty() const { return heap_.empty(); }
+
+    std::size_t size() const { return heap_.size(); }
+
+    // True iff v is in the heap
+    bool contains( vertex_id v ) const { return position_[v] != npos; }
+
+    // The vertex with the least key, and its key
+    // Requires: !empty()
+    vertex_id top() const { return heap_[0].v; }
+    edge_weight top_key() const { return heap_[0].key; }
+
+    // Insert v with key k, or lower v's key to k if v is already in
+    // the heap with a greater key.  Return true iff the heap changed.
+    // Complexity: O( log(n) / log(Arity) )
+    bool push_or_decrease( vertex_id v, edge_weight k )
+    {
+        unsigned i = position_[v];
+        if ( i == npos )
+        {
+            i = heap_.size();
+            heap_.push_back( entry( k, v ) );
+        }
+        else if ( !(k < heap_[i].key) )
+            return false;
+
+        sift_up( i, entry( k, v ) );
+        return true;
+    }
+
+    // Remove and return the vertex with the least key
+    // Requires: !empty()
+    // Complexity: O( Arity x log(n) / log(Arity) )
+    vertex_id pop()
+    {
+        vertex_id v = heap_[0].v;
+        position_[v] = npos;
+        entry last = heap_.back();
+        heap_.pop_back();
+        if ( !heap_.empty() )
+            sift_down( 0, last );
+        return v;
+    }
+
+ private:
+    static unsigned const npos = unsigned( -1 );
+
+    struct entry
+    {
+        entry() {}
+        entry( edge_weight k, vertex_id u ) : key( k ), v( u ) {}
+        edge_weight key;
+        vertex_id v;
+    };
+
+    void place( unsigned i, entry const& e )
+    {
+        heap_[i] = e;
+        position_[e.v] = i;
+    }
+
+    // Put e at slot i or above, moving greater ancestors down
+    void sift_up( unsigned i, entry const& e )
+    {
+        while ( i > 0 )
+        {
+            unsigned parent = (i - 1) / Arity;
+            if ( !(e.key < heap_[parent].key) )
+                break;
+            place( i, heap_[parent] );
+            i = parent;
+        }
+        place( i, e );
+    }
+
+    // Put e at slot i or below, moving lesser children up
+    void sift_down( unsigned i, entry const& e )
+    {
+        for ( unsigned first; (first = i * Arity + 1) < heap_.size(); )
+        {
+            unsigned last = std::min<std::size_t>( first + Arity, heap_.size() ), least = first;
+            for ( unsigned c = first + 1; c < last; ++c )
+                if ( heap_[c].key < heap_[least].key )
+                    least = c;
+            if ( !(heap_[least].key < e.key) )
+                break;
+            place( i, heap_[least] );
+            i = least;
+        }
+        place( i, e );
+    }
+
+    std::vector<entry> heap_;
+    std::vector<unsigned> position_;
+};
+
+template <unsigned Arity>
+unsigned const indexed_heap<Arity>::npos;
+
+edge_weight const infinity = std::numeric_limits<edge_weight>::infinity();
+
+// One direction of a bidirectional Dijkstra search: the graph it
+// walks, each vertex's distance from its starting point, the vertex
+// each was reached from, and the queue of reached but unsettled
+// vertices
+struct dijkstra_side
+{
+    dijkstra_side( graph const& g_, vertex_id start )
+        : g( &g_ ), d( count_vertices( g_ ), infinity ), p( count_vertices( g_ ) ),
+          q( count_vertices( g_ ) )
+    {
+        for ( vertex_id u = 0; u < p.size(); ++u )
+            p[u] = u;
+        d[start] = 0;
+        q.push_or_decrease( start, 0 );
+    }
+
+    graph const* g;
+    std::vector<edge_weight> d;
+    std::vector<vertex_id> p;
+    indexed_heap<> q;
+};
+
+// Settle the head of near's queue and relax its edges.  Whenever an
+// edge lands on a vertex far has reached, lower mu to the length of
+// the path through that edge if it is shorter, and record the vertex
+// in meet.
+void settle_next( dijkstra_side& near, dijkstra_side const& far, edge_weight& mu, vertex_id& meet )
+{
+    vertex_id const u = near.q.pop();
+    graph const& g = *near.g;
+    for ( neighbors_t::const_iterator adj = g[u].begin(), last = g[u].end(); adj != last; ++adj )
+    {
+        vertex_id const v = adj->first;
+        edge_weight const x = near.d[u] + adj->second;
+        if ( x < near.d[v] )
+        {
+            near.d[v] = x;
+            near.p[v] = u;
+            near.q.push_or_decrease( v, x );
+        }
+        if ( x + far.d[v] < mu )
+        {
+            mu = x + far.d[v];
+            meet = v;
+        }
+    }
+}
+
+// Compute the shortest path from s to dst, writing the ids of
+// vertices on the path (excluding s), in reverse order, into
+// out_path.  Return a pair consisting of the total path cost and the
+// resulting value of out_path.  If dst is not reachable the cost is
+// infinity and nothing is written.  Same contract as poor_dijkstra.
+// rg must be transposed_graph( g ).  settled is set to the number of
+// vertices the two searches settled between them.
+//
+// Complexity: O( (|V| + |E|) log(|V|) ) in the worst case
+template <class OutputIterator>
+std::pair<edge_weight,OutputIterator>
+bidirectional_dijkstra(
+    graph const& g, graph const& rg, vertex_id s, vertex_id dst, OutputIterator out_path,
+    std::size_t& settled )
+{
+    assert( count_vertices( rg ) >= count_vertices( g ) );
+    assert( s < count_vertices( g ) && dst < count_vertices( g ) );
+
+    settled = 0;
+    if ( s == dst )
+        return std::make_pair( edge_weight( 0 ), out_path );
+
+    dijkstra_side forward( g, s ), backward( rg, dst );
+    edge_weight mu = infinity;
+    vertex_id meet = s;
+
+    while ( !forward.q.empty() && !backward.q.empty()
+            && forward.q.top_key() + backward.q.top_key() < mu )
+    {
+        if ( forward.q.top_key() <= backward.q.top_key() )
+            settle_next( forward, backward, mu, meet );
+        else
+            settle_next( backward, forward, mu, meet );
+        ++settled;
+    }
+    if ( mu == infinity )
+        return std::make_pair( mu, out_path );
+
+    // The backward search recorded, for each vertex, the next vertex
+    // on its way to dst; write that half of the path from dst back to
+    // meet, then the forward half from meet back to s
+    std::vector<vertex_id> tail;
+    for ( vertex_id x = meet; x != dst; x = backward.p[x] )
+        tail.push_back( backward.p[x] );
+    out_path = std::copy( tail.rbegin(), tail.rend(), out_path );
+    for ( vertex_id x = meet; forward.p[x] != x; x = forward.p[x] )
+        *out_path++ = x;
+
+    return std::make_pair( mu, out_path );
+}
+
+template <class OutputIterator>
+std::pair<edge_weight,OutputIterator>
+bidirectional_dijkstra(
+    graph const& g, graph const& rg, vertex_id s, vertex_id dst, OutputIterator out_path )
+{
+    std::size_t settled;
+    return bidirectional_dijkstra( g, rg, s, dst, out_path, settled );
+}
+
+// Return the length of the shortest path from s to dst in g, found by
+// a one-directional Dijkstra search that stops once dst is settled,
+// and set settled to the number of vertices it settled.
+edge_weight dijkstra_distance( graph const& g, vertex_id s, vertex_id dst, std::size_t& settled )
+{
+    dijkstra_side forward( g, s );
+    for ( settled = 0; !forward.q.empty(); )
+    {
+        vertex_id const u = forward.q.pop();
+        ++settled;
+        if ( u == dst )
+            break;
+        for ( neighbors_t::const_iterator adj = g[u].begin(), last = g[u].end(); adj != last; ++adj )
+        {
+            edge_weight const x = forward.d[u] + adj->second;
+            if ( x < forward.d[adj->first] )
+            {
+                forward.d[adj->first] = x;
+                forward.q.push_or_decrease( adj->first, x );
+            }
+        }
+    }
+    return forward.d[dst];
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = add_vertex( g );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + count_adj(g, src)) * 1.0 / count_vertices(g);
+            add_edge( g, src, dst, w );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << '\n';
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    graph g;
+
+    read_adjacency_list( std::cin, g );
+    write_adjacency_matrix( std::cout, g );
+
+    if ( argc == 3 )
+    {
+        vertex_id u, v;
+        std::stringstream(argv[1]) >> u;
+        std::stringstream(argv[2]) >> v;
+
+        std::size_t settled, one_way;
+        std::cout << "reverse shortest path: ";
+        edge_weight w = bidirectional_dijkstra(
+            g, transposed_graph( g ), u, v,
+            std::ostream_iterator<vertex_id>( std::cout, " " ), settled ).first;
+        std::cout << "has length: " << w << std::endl;
+
+        dijkstra_distance( g, u, v, one_way );
+        std::cout << "settled vertices: " << settled
+                  << " (one-directional dijkstra: " << one_way << ")" << std::endl;
+    }
+}
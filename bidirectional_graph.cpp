@@ -0,0 +1,262 @@
+/*
+    g++ bidirectional_graph.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 3
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    vertex 3 has 2 in-edges, from: 4 5
+    after deleting edge 4->3, vertex 3 has 1 in-edges, from: 5
+
+Notes:
+every edge is stored twice, once in each direction
+add_edge and delete_edge keep both directions in sync
+in_neighbors is O( 1 ); walking it is O( in-degree )
+
+ */
+#define _GLIBCXX_DEBUG
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <iterator>
+#include <algorithm>
+#include <map>
+
+// Adjacency list graph representation
+typedef unsigned vertex_id;
+typedef float edge_weight;
+typedef std::map<vertex_id, edge_weight> neighbors_t;
+typedef std::vector<neighbors_t> graph;
+
+// Unweighted adjacency list graph representation (see
+// edge_list_solution.cpp)
+typedef std::vector<vertex_id> unweighted_neighbors_t;
+typedef std::vector<unweighted_neighbors_t> adjacency_list;
+
+// A graph that also indexes the edges entering each vertex.  For
+// every edge u->v of weight w in out, there is an edge v->u of weight
+// w in in, and vice-versa.
+struct bidirectional_graph
+{
+    graph out;
+    graph in;
+};
+
+// An adjacency_list that also indexes the edges entering each vertex.
+// Both out[u] and in[v] are kept sorted.
+struct bidirectional_adjacency_list
+{
+    adjacency_list out;
+    adjacency_list in;
+};
+
+// Add a vertex to g and return its id
+// Complexity: O( 1 )
+inline vertex_id add_vertex( bidirectional_graph& g )
+{
+    vertex_id v = g.out.size();
+    g.out.resize( v + 1 );
+    g.in.resize( v + 1 );
+    return v;
+}
+
+inline vertex_id add_vertex( bidirectional_adjacency_list& g )
+{
+    vertex_id v = g.out.size();
+    g.out.resize( v + 1 );
+    g.in.resize( v + 1 );
+    return v;
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( bidirectional_graph const& g )
+{
+    return g.out.size();
+}
+
+inline std::size_t count_vertices( bidirectional_adjacency_list const& g )
+{
+    return g.out.size();
+}
+
+// Return the number of outgoing edges from u in g
+inline std::size_t count_adj( bidirectional_graph const& g, vertex_id u )
+{
+    return g.out[u].size();
+}
+
+inline std::size_t count_adj( bidirectional_adjacency_list const& g, vertex_id u )
+{
+    return g.out[u].size();
+}
+
+// Return the number of incoming edges to v in g
+// Complexity: O( 1 )
+inline std::size_t count_in_adj( bidirectional_graph const& g, vertex_id v )
+{
+    return g.in[v].size();
+}
+
+inline std::size_t count_in_adj( bidirectional_adjacency_list const& g, vertex_id v )
+{
+    return g.in[v].size();
+}
+
+// Return the vertices with an edge to v in g, each mapped to the
+// weight of that edge
+// Complexity: O( 1 )
+inline neighbors_t const& in_neighbors( bidirectional_graph const& g, vertex_id v )
+{
+    return g.in[v];
+}
+
+// Return the sorted ids of the vertices with an edge to v in g
+inline unweighted_neighbors_t const&
+in_neighbors( bidirectional_adjacency_list const& g, vertex_id v )
+{
+    return g.in[v];
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(|V|) )
+inline bool has_edge( bidirectional_graph const& g, int u, int v )
+{
+    return g.out[u].find(v) != g.out[u].end();
+}
+
+inline bool has_edge( bidirectional_adjacency_list const& g, int u, int v )
+{
+    return std::binary_search( g.out[u].begin(), g.out[u].end(), vertex_id( v ) );
+}
+
+// Add an edge in g from u to v with weight w
+// Complexity: O( log(|V|) )
+// Requires: u and v are vertices in g
+inline void add_edge( bidirectional_graph& g, vertex_id u, vertex_id v, edge_weight w )
+{
+    assert( u < count_vertices( g ) && v < count_vertices( g ) );
+    if ( g.out[u].insert( std::make_pair( v, w ) ).second )
+        g.in[v].insert( std::make_pair( u, w ) );
+}
+
+// Complexity: O( |V| )
+inline void add_edge( bidirectional_adjacency_list& g, vertex_id u, vertex_id v )
+{
+    assert( u < count_vertices( g ) && v < count_vertices( g ) );
+    g.out[u].insert( std::lower_bound( g.out[u].begin(), g.out[u].end(), v ), v );
+    g.in[v].insert( std::lower_bound( g.in[v].begin(), g.in[v].end(), u ), u );
+}
+
+// Delete the edge in g from u to v, if any
+// Complexity: O( log(|V|) )
+inline void delete_edge( bidirectional_graph& g, vertex_id u, vertex_id v )
+{
+    assert( u < count_vertices( g ) && v < count_vertices( g ) );
+    if ( g.out[u].erase( v ) )
+        g.in[v].erase( u );
+}
+
+// Complexity: O( |V| )
+inline void delete_edge( bidirectional_adjacency_list& g, vertex_id u, vertex_id v )
+{
+    assert( u < count_vertices( g ) && v < count_vertices( g ) );
+    unweighted_neighbors_t::iterator p
+        = std::lower_bound( g.out[u].begin(), g.out[u].end(), v );
+    if ( p == g.out[u].end() || *p != v )
+        return;
+    g.out[u].erase( p );
+    g.in[v].erase( std::lower_bound( g.in[v].begin(), g.in[v].end(), u ) );
+}
+
+// A lightweight function object that projects from a pair onto its
+// "first" member
+struct project1st
+{
+    // Complexity: O( 1 )
+    template <class Pair>
+    typename Pair::first_type operator()( Pair const& p )
+    {
+        return p.first;
+    }
+};
+
+// Read a graph from input in adjacency list form.  Vertices are
+// created on demand, since an edge may name a vertex whose line has
+// not been read yet.
+void read_adjacency_list( std::istream& input, bidirectional_graph& g )
+{
+    vertex_id src = 0;
+    for ( std::string line; std::getline(input, line); ++src )
+    {
+        while ( src >= count_vertices( g ) )
+            add_vertex( g );
+
+        std::stringstream s(line);
+        for ( vertex_id dst; s >> dst; )
+        {
+            while ( dst >= count_vertices( g ) )
+                add_vertex( g );
+
+            // Make up an arbitrary weight
+            edge_weight w = (1 + count_adj(g, src)) * 1.0 / count_vertices(g);
+            add_edge( g, src, dst, w );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, bidirectional_graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << std::endl;
+    }
+}
+
+// Write the number and ids of the vertices with an edge to v
+void write_in_neighbors( std::ostream& output, bidirectional_graph const& g, vertex_id v )
+{
+    output << "vertex " << v << " has " << count_in_adj( g, v ) << " in-edges, from: ";
+    std::transform( in_neighbors( g, v ).begin(), in_neighbors( g, v ).end(),
+                    std::ostream_iterator<vertex_id>( output, " " ),
+                    project1st()
+        );
+    output << std::endl;
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    bidirectional_graph g;
+
+    read_adjacency_list( std::cin, g );
+    write_adjacency_matrix( std::cout, g );
+
+    if ( argc == 2 )
+    {
+        vertex_id v;
+        std::stringstream(argv[1]) >> v;
+
+        write_in_neighbors( std::cout, g, v );
+
+        if ( count_in_adj( g, v ) != 0 )
+        {
+            vertex_id u = in_neighbors( g, v ).begin()->first;
+            delete_edge( g, u, v );
+            std::cout << "after deleting edge " << u << "->" << v << ", ";
+            write_in_neighbors( std::cout, g, v );
+        }
+    }
+}
@@ -0,0 +1,437 @@
+/*
+    g++ binary_graph.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g write graph.bin
+    ./g graph.bin 2 0
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    vertex 0 is reachable from vertex 2
+    edge 2->5 has weight 0.666667
+
+Notes:
+file layout: header, offsets section, targets section, weights section
+sections are 8-byte aligned so they can be used in place
+opening a file maps it read-only; nothing is copied, and only the
+offsets are checked, so the targets are trusted to be vertices
+a file written on a machine of different byte order is rejected
+
+ */
+#define _GLIBCXX_DEBUG
+#include <istream>
+#include <ostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <map>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+typedef unsigned vertex_id;
+typedef float edge_weight;
+
+// Edge list graph representation (see edge_list_solution.cpp)
+typedef std::pair<vertex_id, vertex_id> edge;
+typedef std::vector<edge> edge_list;
+
+// Adjacency list graph representation (see edge_list_solution.cpp)
+typedef std::vector<vertex_id> neighbors_t;
+typedef std::vector<neighbors_t> adjacency_list;
+
+// Weighted adjacency list graph representation (see map_bfs_solution.cpp)
+typedef std::map<vertex_id, edge_weight> weighted_neighbors_t;
+typedef std::vector<weighted_neighbors_t> graph;
+
+// The fixed-size header at the start of a binary graph file.  Each
+// *_start field is the byte offset of a section from the start of the
+// file.  The sections hold vertex_count + 1 std::uint64_t offsets,
+// then edge_count vertex_ids, then edge_count edge_weights, in the
+// compressed sparse row layout of csr_graph.cpp.
+struct graph_file_header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t vertex_count;
+    std::uint64_t edge_count;
+    std::uint64_t offsets_start;
+    std::uint64_t targets_start;
+    std::uint64_t weights_start;
+    std::uint64_t file_size;
+};
+
+char const graph_file_magic[8] = { 'L', 'A', 'B', 'G', 'R', 'A', 'P', 'H' };
+std::uint32_t const graph_file_version = 1;
+std::uint32_t const graph_file_byte_order = 0x01020304;
+
+// Return n rounded up to a multiple of 8
+inline std::uint64_t align8( std::uint64_t n )
+{
+    return (n + 7) & ~std::uint64_t( 7 );
+}
+
+// Fill in a header for a graph of the given size
+graph_file_header make_graph_file_header( std::uint64_t vertex_count, std::uint64_t edge_count )
+{
+    graph_file_header h;
+    std::memset( &h, 0, sizeof( h ) );
+    std::memcpy( h.magic, graph_file_magic, sizeof( h.magic ) );
+    h.version = graph_file_version;
+    h.byte_order = graph_file_byte_order;
+    h.vertex_count = vertex_count;
+    h.edge_count = edge_count;
+    h.offsets_start = align8( sizeof( h ) );
+    h.targets_start = align8( h.offsets_start + (vertex_count + 1) * sizeof( std::uint64_t ) );
+    h.weights_start = align8( h.targets_start + edge_count * sizeof( vertex_id ) );
+    h.file_size = align8( h.weights_start + edge_count * sizeof( edge_weight ) );
+    return h;
+}
+
+// Write zero bytes to output, which is at position written, until it
+// reaches position pos
+void pad_to( std::ostream& output, std::uint64_t written, std::uint64_t pos )
+{
+    static char const zeros[8] = {};
+    assert( pos >= written && pos - written < 8 );
+    output.write( zeros, pos - written );
+}
+
+// Write a binary graph file with the given header and sections
+void write_graph_file(
+    std::string const& path, graph_file_header const& h,
+    std::vector<std::uint64_t> const& offsets,
+    std::vector<vertex_id> const& targets,
+    std::vector<edge_weight> const& weights )
+{
+    std::ofstream output( path.c_str(), std::ios::binary | std::ios::trunc );
+    if ( !output )
+        throw std::runtime_error( "cannot create " + path );
+
+    output.write( reinterpret_cast<char const*>( &h ), sizeof( h ) );
+    pad_to( output, sizeof( h ), h.offsets_start );
+    output.write( reinterpret_cast<char const*>( offsets.data() ),
+                  offsets.size() * sizeof( std::uint64_t ) );
+    pad_to( output, h.offsets_start + offsets.size() * sizeof( std::uint64_t ), h.targets_start );
+    output.write( reinterpret_cast<char const*>( targets.data() ),
+                  targets.size() * sizeof( vertex_id ) );
+    pad_to( output, h.targets_start + targets.size() * sizeof( vertex_id ), h.weights_start );
+    output.write( reinterpret_cast<char const*>( weights.data() ),
+                  weights.size() * sizeof( edge_weight ) );
+    pad_to( output, h.weights_start + weights.size() * sizeof( edge_weight ), h.file_size );
+
+    if ( !output.flush() )
+        throw std::runtime_error( "cannot write " + path );
+}
+
+// Write g to path in binary graph form
+// Complexity: O( |V| + |E| )
+void write_binary_graph( std::string const& path, graph const& g )
+{
+    std::vector<std::uint64_t> offsets( 1, 0 );
+    std::vector<vertex_id> targets;
+    std::vector<edge_weight> weights;
+    for ( vertex_id u = 0; u < g.size(); ++u )
+    {
+        for ( weighted_neighbors_t::const_iterator p = g[u].begin(), e = g[u].end();
+              p != e; ++p )
+        {
+            targets.push_back( p->first );
+            weights.push_back( p->second );
+        }
+        offsets.push_back( targets.size() );
+    }
+    write_graph_file(
+        path, make_graph_file_header( g.size(), targets.size() ), offsets, targets, weights );
+}
+
+// Every edge is given weight w.
+void write_binary_graph( std::string const& path, adjacency_list const& g, edge_weight w = 1 )
+{
+    std::vector<std::uint64_t> offsets( 1, 0 );
+    std::vector<vertex_id> targets;
+    for ( vertex_id u = 0; u < g.size(); ++u )
+    {
+        targets.insert( targets.end(), g[u].begin(), g[u].end() );
+        offsets.push_back( targets.size() );
+    }
+    std::vector<edge_weight> weights( targets.size(), w );
+    write_graph_file(
+        path, make_graph_file_header( g.size(), targets.size() ), offsets, targets, weights );
+}
+
+// Every edge is given weight w.  Requires: g is sorted, as add_edge
+// keeps it.
+void write_binary_graph( std::string const& path, edge_list const& g, edge_weight w = 1 )
+{
+    std::size_t vcnt = 0;
+    for ( edge_list::const_iterator p = g.begin(), e = g.end(); p != e; ++p )
+        vcnt = std::max( vcnt, std::size_t( std::max( p->first, p->second ) ) + 1 );
+
+    std::vector<std::uint64_t> offsets( vcnt + 1, 0 );
+    std::vector<vertex_id> targets;
+    targets.reserve( g.size() );
+    for ( edge_list::const_iterator p = g.begin(), e = g.end(); p != e; ++p )
+    {
+        assert( p == g.begin() || p[-1] <= *p );
+        ++offsets[p->first + 1];
+        targets.push_back( p->second );
+    }
+    for ( std::size_t u = 0; u < vcnt; ++u )
+        offsets[u + 1] += offsets[u];
+
+    std::vector<edge_weight> weights( targets.size(), w );
+    write_graph_file(
+        path, make_graph_file_header( vcnt, targets.size() ), offsets, targets, weights );
+}
+
+// A read-only graph backed by a memory-mapped binary graph file.
+// Opening validates the header and section bounds, and checks in
+// O( |V| ) that the offsets rise from 0 to edge_count; the sections
+// are then used in place.  The targets are not checked: each is
+// trusted to be less than vertex_count.  Pages are read from disk on
+// first touch.
+class mapped_graph
+{
+ public:
+    explicit mapped_graph( std::string const& path )
+        : base_(0), length_(0)
+    {
+        int fd = ::open( path.c_str(), O_RDONLY );
+        if ( fd < 0 )
+            throw std::runtime_error( "cannot open " + path );
+
+        struct stat st;
+        if ( ::fstat( fd, &st ) != 0 || std::uint64_t( st.st_size ) < sizeof( graph_file_header ) )
+        {
+            ::close( fd );
+            throw std::runtime_error( path + " is not a binary graph file" );
+        }
+        length_ = st.st_size;
+        void* p = ::mmap( 0, length_, PROT_READ, MAP_SHARED, fd, 0 );
+        ::close( fd );
+        if ( p == MAP_FAILED )
+            throw std::runtime_error( "cannot map " + path );
+        base_ = static_cast<char const*>( p );
+
+        header_ = reinterpret_cast<graph_file_header const*>( base_ );
+        if ( !valid() )
+        {
+            ::munmap( const_cast<char*>( base_ ), length_ );
+            throw std::runtime_error( path + " is not a version 1 binary graph file" );
+        }
+    }
+
+    ~mapped_graph()
+    {
+        ::munmap( const_cast<char*>( base_ ), length_ );
+    }
+
+    mapped_graph( mapped_graph const& ) = delete;
+    mapped_graph& operator=( mapped_graph const& ) = delete;
+
+    std::size_t vertex_count() const { return header_->vertex_count; }
+    std::size_t edge_count() const { return header_->edge_count; }
+
+    std::uint64_t const* offsets() const
+    {
+        return reinterpret_cast<std::uint64_t const*>( base_ + header_->offsets_start );
+    }
+
+    vertex_id const* targets() const
+    {
+        return reinterpret_cast<vertex_id const*>( base_ + header_->targets_start );
+    }
+
+    edge_weight const* weights() const
+    {
+        return reinterpret_cast<edge_weight const*>( base_ + header_->weights_start );
+    }
+
+ private:
+    // True iff the header matches the layout make_graph_file_header
+    // gives its counts, the sections fit in the mapping, and the
+    // offsets are non-decreasing from 0 to edge_count.  The counts are
+    // bounded by the mapping's length first, so the section positions
+    // computed from them cannot wrap around.
+    bool valid() const
+    {
+        if ( std::memcmp( header_->magic, graph_file_magic, sizeof( graph_file_magic ) ) != 0
+             || header_->byte_order != graph_file_byte_order
+             || header_->version != graph_file_version
+             || header_->vertex_count >= length_ / sizeof( std::uint64_t )
+             || header_->edge_count > length_ / sizeof( vertex_id ) )
+            return false;
+
+        graph_file_header expected
+            = make_graph_file_header( header_->vertex_count, header_->edge_count );
+        if ( header_->offsets_start != expected.offsets_start
+             || header_->targets_start != expected.targets_start
+             || header_->weights_start != expected.weights_start
+             || header_->file_size != expected.file_size
+             || header_->file_size > length_ )
+            return false;
+
+        std::uint64_t const* o = offsets();
+        for ( std::uint64_t u = 0; u < header_->vertex_count; ++u )
+            if ( o[u] > o[u + 1] )
+                return false;
+        return o[0] == 0 && o[header_->vertex_count] == header_->edge_count;
+    }
+
+    char const* base_;
+    std::size_t length_;
+    graph_file_header const* header_;
+};
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( mapped_graph const& g )
+{
+    return g.vertex_count();
+}
+
+// Return the number of outgoing edges from u in g
+// Complexity: O( 1 )
+inline std::size_t count_adj( mapped_graph const& g, vertex_id u )
+{
+    return g.offsets()[u + 1] - g.offsets()[u];
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(count_adj(g, u)) )
+inline bool has_edge( mapped_graph const& g, int u, int v )
+{
+    vertex_id const* first = g.targets() + g.offsets()[u];
+    vertex_id const* last = g.targets() + g.offsets()[u + 1];
+    return std::binary_search( first, last, vertex_id( v ) );
+}
+
+// Return the weight of the edge in g from u to v
+// Requires: has_edge( g, u, v )
+inline edge_weight get_weight( mapped_graph const& g, vertex_id u, vertex_id v )
+{
+    vertex_id const* first = g.targets() + g.offsets()[u];
+    vertex_id const* last = g.targets() + g.offsets()[u + 1];
+    vertex_id const* p = std::lower_bound( first, last, v );
+    assert( p != last && *p == v );
+    return g.weights()[p - g.targets()];
+}
+
+// A simple breadth-first search starting from u for vertex v.
+// Returns true iff v is reachable from u.  Complexity: O(|V|+|E|)
+bool bfs( mapped_graph const& g, vertex_id u, vertex_id v )
+{
+    std::vector<bool> visited( count_vertices( g ) );
+    std::vector<vertex_id> q( 1, u );
+    visited[u] = true;
+
+    for ( std::size_t head = 0; head != q.size(); ++head )
+    {
+        vertex_id const next = q[head];
+        if ( next == v )
+            return true;
+
+        for ( std::uint64_t i = g.offsets()[next], last = g.offsets()[next + 1]; i != last; ++i )
+        {
+            vertex_id w = g.targets()[i];
+            if ( !visited[w] )
+            {
+                visited[w] = true;
+                q.push_back( w );
+            }
+        }
+    }
+    return false;
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = g.size();
+        g.resize( src + 1 );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + g[src].size()) * 1.0 / g.size();
+            g[src].insert( std::make_pair( vertex_id( dst ), w ) );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, mapped_graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << std::endl;
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    bool writing = argc > 1 && std::string( argv[1] ) == "write";
+    if ( writing ? argc != 3 : argc != 2 && argc != 4 )
+    {
+        std::cerr << "usage: " << argv[0] << " write FILE < adjacency-list" << std::endl
+                  << "       " << argv[0] << " FILE [u v]" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        if ( writing )
+        {
+            graph g;
+            read_adjacency_list( std::cin, g );
+            write_binary_graph( argv[2], g );
+            return 0;
+        }
+
+        mapped_graph g( argv[1] );
+        write_adjacency_matrix( std::cout, g );
+
+        if ( argc == 4 )
+        {
+            vertex_id u, v;
+            std::stringstream(argv[2]) >> u;
+            std::stringstream(argv[3]) >> v;
+
+            std::cout << "vertex " << v << " is " << (bfs( g, u, v ) ? "" : "not ")
+                      << "reachable from vertex " << u << std::endl;
+
+            if ( count_adj( g, u ) != 0 )
+            {
+                vertex_id w = g.targets()[g.offsets()[u + 1] - 1];
+                std::cout << "edge " << u << "->" << w << " has weight "
+                          << get_weight( g, u, w ) << std::endl;
+            }
+        }
+    }
+    catch ( std::exception const& e )
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
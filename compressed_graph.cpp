@@ -0,0 +1,385 @@
+/*
+    g++ compressed_graph.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 2 0
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    common neighbors of vertices 2 and 0:
+    vertex 0 is reachable from vertex 2
+    9 edges in 99 bytes (adjacency_list: 180 bytes)
+
+Notes:
+each sorted neighbor list is stored as its length followed by the
+gaps between successive neighbors
+every integer is a varint: 7 bits per byte, high bit set on all but
+the last byte, so small gaps take one byte
+lists longer than a block get skip pointers so has_edge need not
+decode the whole list
+
+ */
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <iterator>
+#include <algorithm>
+#include <map>
+#include <cstddef>
+
+typedef unsigned vertex_id;
+typedef float edge_weight;
+
+// Adjacency list graph representation (see edge_list_solution.cpp)
+typedef std::vector<vertex_id> neighbors_t;
+typedef std::vector<neighbors_t> adjacency_list;
+
+// Weighted adjacency list graph representation (see map_bfs_solution.cpp)
+typedef std::map<vertex_id, edge_weight> weighted_neighbors_t;
+typedef std::vector<weighted_neighbors_t> graph;
+
+// Append x to bytes as a varint
+// Complexity: O( log(x) )
+inline void encode_varint( std::vector<unsigned char>& bytes, vertex_id x )
+{
+    while ( x >= 0x80 )
+    {
+        bytes.push_back( (x & 0x7F) | 0x80 );
+        x >>= 7;
+    }
+    bytes.push_back( x );
+}
+
+// Decode the varint starting at p, advancing p past it
+// Complexity: O( log(result) )
+inline vertex_id decode_varint( unsigned char const*& p )
+{
+    vertex_id x = 0;
+    for ( unsigned shift = 0; ; shift += 7 )
+    {
+        unsigned char b = *p++;
+        x |= vertex_id( b & 0x7F ) << shift;
+        if ( !(b & 0x80) )
+            return x;
+    }
+}
+
+// A position within a long neighbor list: the value of some neighbor
+// and the byte offset, from the start of the list, of the gap that
+// follows it.
+struct skip_pointer
+{
+    vertex_id value;
+    std::size_t position;
+};
+
+// Gap-encoded, varint-compressed, unweighted graph representation.
+// Vertex u's neighbors are encoded in bytes[offsets[u]] ..
+// bytes[offsets[u+1]-1], as count_adj( g, u ) followed by the gaps.
+// If block_size is nonzero, the neighbors at indices block_size,
+// 2*block_size... of u's list are indexed by skips[skip_offsets[u]]
+// .. skips[skip_offsets[u+1]-1].
+struct compressed_graph
+{
+    std::vector<std::size_t> offsets;
+    std::vector<unsigned char> bytes;
+
+    unsigned block_size;
+    std::vector<unsigned> skip_offsets;
+    std::vector<skip_pointer> skips;
+};
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( compressed_graph const& g )
+{
+    return g.offsets.size() - 1;
+}
+
+// Return the number of outgoing edges from u in g
+// Complexity: O( 1 )
+inline std::size_t count_adj( compressed_graph const& g, vertex_id u )
+{
+    unsigned char const* p = &g.bytes[g.offsets[u]];
+    return decode_varint( p );
+}
+
+// Return the number of bytes used by g's arrays
+inline std::size_t memory_bytes( compressed_graph const& g )
+{
+    return g.offsets.size() * sizeof( std::size_t )
+        + g.bytes.size()
+        + g.skip_offsets.size() * sizeof( unsigned )
+        + g.skips.size() * sizeof( skip_pointer );
+}
+
+// A forward iterator that decodes a compressed neighbor list on the
+// fly.  Two iterators over the same list are equal when they have
+// the same number of neighbors left to decode.
+class neighbor_iterator
+{
+ public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef vertex_id value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef vertex_id const* pointer;
+    typedef vertex_id const& reference;
+
+    neighbor_iterator() : next_(0), remaining_(0), value_(0) {}
+
+    // An iterator whose next gap is at next, with remaining neighbors
+    // left including the current one, whose value is value
+    neighbor_iterator( unsigned char const* next, std::size_t remaining, vertex_id value )
+        : next_(next), remaining_(remaining), value_(value) {}
+
+    reference operator*() const { return value_; }
+    pointer operator->() const { return &value_; }
+
+    neighbor_iterator& operator++()
+    {
+        if ( --remaining_ != 0 )
+            value_ += decode_varint( next_ );
+        return *this;
+    }
+
+    neighbor_iterator operator++(int)
+    {
+        neighbor_iterator old( *this );
+        ++*this;
+        return old;
+    }
+
+    friend bool operator==( neighbor_iterator const& x, neighbor_iterator const& y )
+    {
+        return x.remaining_ == y.remaining_;
+    }
+
+    friend bool operator!=( neighbor_iterator const& x, neighbor_iterator const& y )
+    {
+        return x.remaining_ != y.remaining_;
+    }
+
+ private:
+    unsigned char const* next_;
+    std::size_t remaining_;
+    vertex_id value_;
+};
+
+// Return the first and past-the-end positions of u's neighbors in g
+// Complexity: O( 1 )
+inline std::pair<neighbor_iterator, neighbor_iterator>
+adjacent_vertices( compressed_graph const& g, vertex_id u )
+{
+    unsigned char const* p = &g.bytes[g.offsets[u]];
+    std::size_t n = decode_varint( p );
+    if ( n == 0 )
+        return std::make_pair( neighbor_iterator(), neighbor_iterator() );
+
+    vertex_id first = decode_varint( p );
+    return std::make_pair( neighbor_iterator( p, n, first ), neighbor_iterator() );
+}
+
+// True iff there is an edge in g from u to v.  Without skip pointers
+// u's list is decoded until a neighbor >= v is found; with them, a
+// binary search over the skip pointers picks the only block that can
+// hold v.
+// Complexity: O( log(count_adj(g, u)) + block_size ) with skip pointers,
+// otherwise O( count_adj(g, u) )
+inline bool has_edge( compressed_graph const& g, int u, int v )
+{
+    std::pair<neighbor_iterator, neighbor_iterator> adj = adjacent_vertices( g, u );
+    neighbor_iterator p = adj.first;
+
+    if ( g.block_size != 0 && g.skip_offsets[u] != g.skip_offsets[u + 1] )
+    {
+        skip_pointer const* first = &g.skips[0] + g.skip_offsets[u];
+        skip_pointer const* last = &g.skips[0] + g.skip_offsets[u + 1];
+
+        // Find the last block starting at or before v
+        skip_pointer const* s = first;
+        for ( std::size_t n = last - first; n > 0; )
+        {
+            std::size_t half = n / 2;
+            if ( s[half].value <= vertex_id( v ) )
+            {
+                s += half + 1;
+                n -= half + 1;
+            }
+            else
+                n = half;
+        }
+        if ( s != first )
+        {
+            --s;
+            std::size_t index = (s - first + 1) * g.block_size;
+            p = neighbor_iterator(
+                &g.bytes[g.offsets[u]] + s->position, count_adj( g, u ) - index, s->value );
+        }
+    }
+
+    for ( ; p != adj.second && *p < vertex_id( v ); ++p )
+        ;
+    return p != adj.second && *p == vertex_id( v );
+}
+
+// Build a compressed_graph from an adjacency_list whose neighbor
+// lists are sorted, as add_edge keeps them.  Lists longer than
+// block_size get skip pointers; a block_size of 0 disables them.
+// Complexity: O( |V| + |E| )
+compressed_graph make_compressed_graph( adjacency_list const& g, unsigned block_size = 64 )
+{
+    compressed_graph result;
+    result.block_size = block_size;
+    result.offsets.reserve( g.size() + 1 );
+    result.skip_offsets.reserve( g.size() + 1 );
+
+    for ( vertex_id u = 0; u < g.size(); ++u )
+    {
+        std::size_t start = result.bytes.size();
+        result.offsets.push_back( start );
+        result.skip_offsets.push_back( result.skips.size() );
+
+        encode_varint( result.bytes, g[u].size() );
+        vertex_id prev = 0;
+        for ( std::size_t i = 0; i < g[u].size(); ++i )
+        {
+            assert( i == 0 || g[u][i] >= prev );
+            encode_varint( result.bytes, g[u][i] - prev );
+            prev = g[u][i];
+
+            if ( block_size != 0 && i != 0 && i % block_size == 0 )
+            {
+                skip_pointer s = { prev, result.bytes.size() - start };
+                result.skips.push_back( s );
+            }
+        }
+    }
+    result.offsets.push_back( result.bytes.size() );
+    result.skip_offsets.push_back( result.skips.size() );
+    return result;
+}
+
+// Build a compressed_graph from the map-based graph.  Weights are
+// dropped.
+// Complexity: O( |V| + |E| )
+compressed_graph make_compressed_graph( graph const& g, unsigned block_size = 64 )
+{
+    adjacency_list a( g.size() );
+    for ( vertex_id u = 0; u < g.size(); ++u )
+        for ( weighted_neighbors_t::const_iterator p = g[u].begin(), e = g[u].end();
+              p != e; ++p )
+            a[u].push_back( p->first );
+    return make_compressed_graph( a, block_size );
+}
+
+// Find all vertices reachable in one step from both u and v, and
+// write their ids into results.  Return the past-the-end position in
+// the sequence of written result values.
+//
+// Complexity: O( count_adj(g, u) + count_adj(g, v) )
+template <class OutputIterator>
+OutputIterator
+common_neighbors(
+    compressed_graph const& g, vertex_id u, vertex_id v, OutputIterator results )
+{
+    std::pair<neighbor_iterator, neighbor_iterator>
+        adj_u = adjacent_vertices( g, u ), adj_v = adjacent_vertices( g, v );
+    return std::set_intersection(
+        adj_u.first, adj_u.second, adj_v.first, adj_v.second, results );
+}
+
+// A simple breadth-first search starting from u for vertex v.
+// Returns true iff v is reachable from u.  Each neighbor list is
+// decoded once, as its vertex is dequeued.
+// Complexity: O(|V|+|E|)
+bool bfs( compressed_graph const& g, vertex_id u, vertex_id v )
+{
+    std::vector<bool> visited( count_vertices( g ) );
+    std::vector<vertex_id> q( 1, u );
+    visited[u] = true;
+
+    for ( std::size_t head = 0; head != q.size(); ++head )
+    {
+        vertex_id const next = q[head];
+        if ( next == v )
+            return true;
+
+        std::pair<neighbor_iterator, neighbor_iterator> adj = adjacent_vertices( g, next );
+        for ( neighbor_iterator p = adj.first; p != adj.second; ++p )
+        {
+            if ( !visited[*p] )
+            {
+                visited[*p] = true;
+                q.push_back( *p );
+            }
+        }
+    }
+    return false;
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, adjacency_list& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        g.push_back( neighbors_t() );
+
+        std::stringstream s(line);
+        for ( vertex_id dst; s >> dst; )
+            g.back().push_back( dst );
+        std::sort( g.back().begin(), g.back().end() );
+        g.back().erase( std::unique( g.back().begin(), g.back().end() ), g.back().end() );
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, compressed_graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << std::endl;
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    adjacency_list a;
+    read_adjacency_list( std::cin, a );
+
+    compressed_graph g = make_compressed_graph( a );
+    write_adjacency_matrix( std::cout, g );
+
+    if ( argc == 3 )
+    {
+        vertex_id u, v;
+        std::stringstream(argv[1]) >> u;
+        std::stringstream(argv[2]) >> v;
+
+        std::cout << "common neighbors of vertices " << u << " and " << v << ": ";
+        common_neighbors( g, u, v, std::ostream_iterator<vertex_id>( std::cout, " " ) );
+        std::cout << std::endl;
+
+        std::cout << "vertex " << v << " is " << (bfs( g, u, v ) ? "" : "not ")
+                  << "reachable from vertex " << u << std::endl;
+    }
+
+    std::size_t edges = 0, uncompressed = a.size() * sizeof( neighbors_t );
+    for ( vertex_id u = 0; u < a.size(); ++u )
+    {
+        edges += a[u].size();
+        uncompressed += a[u].size() * sizeof( vertex_id );
+    }
+    std::cout << edges << " edges in " << memory_bytes( g ) << " bytes"
+              << " (adjacency_list: " << uncompressed << " bytes)" << std::endl;
+}
@@ -0,0 +1,1288 @@
+/*
+    g++ -O2 -pthread contraction_hierarchy.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 2 0
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    reverse shortest path: 0 3 4 has length: 0.783333
+    settled vertices: 4
+    hierarchy: 2 shortcuts, built in ... ms
+
+    ./g table v... < adjacency-list     prints the distance from each v to each
+    ./g write FILE < adjacency-list     builds a hierarchy and saves it
+    ./g FILE u v                        loads one and answers a query
+
+Notes:
+contraction hierarchies (Geisberger, Sanders, Schultes & Delling,
+"Contraction Hierarchies: Faster and Simpler Hierarchical Routing in
+Road Networks", WEA 2008)
+preprocessing removes ("contracts") vertices one at a time, least
+important first; whenever a shortest path ran u -> v -> w through the
+removed vertex v and no other path is as short (a witness), a
+shortcut u -> w is added in its place
+each vertex is ranked by when it was contracted; a query searches
+forward from s and backward from t using only edges toward higher
+ranks, and the two searches meet at the path's highest-ranked vertex
+a shortcut remembers the vertex it bypasses, so a path of shortcuts
+unpacks into original edges
+importance is the edge difference (shortcuts added minus edges
+removed) plus the number of neighbors already contracted; queued
+vertices carry a cheap estimate from short witness searches, and the
+full count is taken only at the front of the queue, where its
+shortcuts are kept for the contraction itself
+a distance table between many sources and targets uses buckets: each
+target's backward search leaves its distance at every vertex it
+settles, and each source's forward search reads the buckets it
+passes, so every source-target pair costs one bucket entry rather
+than a search; the searches run in parallel
+
+ */
+#include <istream>
+#include <ostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <queue>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <chrono>
+#include <numeric>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Adjacency list graph representation
+typedef unsigned vertex_id;
+typedef float edge_weight;
+typedef std::map<vertex_id, edge_weight> neighbors_t;
+typedef std::vector<neighbors_t> graph;
+
+// Add a vertex to g and return its id
+// Complexity: O( 1 )
+inline vertex_id add_vertex( graph& g )
+{
+    vertex_id v = g.size();
+    g.resize( v + 1 );
+    return v;
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( graph const& g )
+{
+    return g.size();
+}
+
+// Return the number of outgoing edges from u in g
+inline std::size_t count_adj( graph const& g, vertex_id u )
+{
+    return g[u].size();
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(|V|) )
+inline bool has_edge(graph const& g, int u, int v)
+{
+    return g[u].find(v) != g[u].end();
+}
+
+// Add an edge in g from u to v with weight w
+// Complexity: O( log(|V|) )
+// Requires: u is a vertex in g, i.e. u < count_vertices( g )
+inline void add_edge( graph& g, vertex_id u, vertex_id v, edge_weight w )
+{
+    assert( u < count_vertices( g ) );
+    g[u].insert( std::make_pair( v, w ) );
+}
+
+// A d-ary min-heap of vertices keyed by edge_weight, holding each
+// vertex at most once.  Vertices must be less than the n given to the
+// constructor.
+template <unsigned Arity = 4>
+class indexed_heap
+{
+ public:
+    explicit indexed_heap( std::size_t n = 0 ) : position_( n, npos ) {}
+
+    bool empty() const { return heap_.empty(); }
+
+    std::size_t size() const { return heap_.size(); }
+
+    // True iff v is in the heap
+    bool contains( vertex_id v ) const { return position_[v] != npos; }
+
+    // The vertex with the least key, and its key
+    // Requires: !empty()
+    vertex_id top() const { return heap_[0].v; }
+    edge_weight top_key() const { return heap_[0].key; }
+
+    // Insert v with key k, or lower v's key to k if v is already in
+    // the heap with a greater key.  Return true iff the heap changed.
+    // Complexity: O( log(n) / log(Arity) )
+    bool push_or_decrease( vertex_id v, edge_weight k )
+    {
+        unsigned i = position_[v];
+        if ( i == npos )
+        {
+            i = heap_.size();
+            heap_.push_back( entry( k, v ) );
+        }
+        else if ( !(k < heap_[i].key) )
+            return false;
+
+        sift_up( i, entry( k, v ) );
+        return true;
+    }
+
+    // Empty the heap and make room for vertices less than n
+    // Complexity: O( size() ), plus any growth
+    void reset( std::size_t n )
+    {
+        for ( std::size_t i = 0; i < heap_.size(); ++i )
+            position_[heap_[i].v] = npos;
+        heap_.clear();
+        if ( position_.size() < n )
+            position_.resize( n, npos );
+    }
+
+    // Remove and return the vertex with the least key
+    // Requires: !empty()
+    // Complexity: O( Arity x log(n) / log(Arity) )
+    vertex_id pop()
+    {
+        vertex_id v = heap_[0].v;
+        position_[v] = npos;
+        entry last = heap_.back();
+        heap_.pop_back();
+        if ( !heap_.empty() )
+            sift_down( 0, last );
+        return v;
+    }
+
+ private:
+    static unsigned const npos = unsigned( -1 );
+
+    struct entry
+    {
+        entry() {}
+        entry( edge_weight k, vertex_id u ) : key( k ), v( u ) {}
+        edge_weight key;
+        vertex_id v;
+    };
+
+    void place( unsigned i, entry const& e )
+    {
+        heap_[i] = e;
+        position_[e.v] = i;
+    }
+
+    // Put e at slot i or above, moving greater ancestors down
+    void sift_up( unsigned i, entry const& e )
+    {
+        while ( i > 0 )
+        {
+            unsigned parent = (i - 1) / Arity;
+            if ( !(e.key < heap_[parent].key) )
+                break;
+            place( i, heap_[parent] );
+            i = parent;
+        }
+        place( i, e );
+    }
+
+    // Put e at slot i or below, moving lesser children up
+    void sift_down( unsigned i, entry const& e )
+    {
+        for ( unsigned first; (first = i * Arity + 1) < heap_.size(); )
+        {
+            unsigned last = std::min<std::size_t>( first + Arity, heap_.size() ), least = first;
+            for ( unsigned c = first + 1; c < last; ++c )
+                if ( heap_[c].key < heap_[least].key )
+                    least = c;
+            if ( !(heap_[least].key < e.key) )
+                break;
+            place( i, heap_[least] );
+            i = least;
+        }
+        place( i, e );
+    }
+
+    std::vector<entry> heap_;
+    std::vector<unsigned> position_;
+};
+
+template <unsigned Arity>
+unsigned const indexed_heap<Arity>::npos;
+
+edge_weight const infinity = std::numeric_limits<edge_weight>::infinity();
+
+// The middle vertex of an edge that is not a shortcut
+vertex_id const no_vertex = std::numeric_limits<vertex_id>::max();
+
+// An edge of a hierarchy, stored at its lower-ranked end: the other
+// end, the weight, and, for a shortcut, the vertex it bypasses
+struct ch_edge
+{
+    vertex_id target;
+    edge_weight weight;
+    vertex_id middle;
+};
+
+// Order ch_edges by target, for binary search
+inline bool operator<( ch_edge const& e, vertex_id v )
+{
+    return e.target < v;
+}
+
+// A contraction hierarchy.  rank[v] is the position of v in the
+// contraction order.  v's upward edges, v -> w with rank[w] > rank[v],
+// are up[up_offsets[v]] .. up[up_offsets[v+1]-1]; its downward edges,
+// w -> v with rank[w] > rank[v], are likewise in down, with w as the
+// target.  Both ranges are sorted by target.
+struct contraction_hierarchy
+{
+    std::vector<unsigned> rank;
+    std::vector<std::uint64_t> up_offsets;
+    std::vector<ch_edge> up;
+    std::vector<std::uint64_t> down_offsets;
+    std::vector<ch_edge> down;
+};
+
+// Return the number of vertices in h
+inline std::size_t count_vertices( contraction_hierarchy const& h )
+{
+    return h.rank.size();
+}
+
+// Return the edge of h's upward (or downward) edges stored at v with
+// the given target; it must exist
+ch_edge const& find_edge(
+    std::vector<std::uint64_t> const& offsets, std::vector<ch_edge> const& edges,
+    vertex_id v, vertex_id target )
+{
+    std::vector<ch_edge>::const_iterator e = std::lower_bound(
+        edges.begin() + offsets[v], edges.begin() + offsets[v + 1], target );
+    assert( e != edges.begin() + offsets[v + 1] && e->target == target );
+    return *e;
+}
+
+// The weight and bypassed vertex of an edge of the graph left during
+// contraction
+struct arc
+{
+    edge_weight weight;
+    vertex_id middle;
+};
+
+// The edges at a vertex during contraction, sorted by the vertex at
+// their other end.  Vertices keep few edges, so a sorted vector is
+// cheaper to search and to scan than a tree.
+typedef std::vector<std::pair<vertex_id, arc> > arcs_t;
+
+// Order arcs by the vertex at their other end, for binary search
+inline bool arc_before( std::pair<vertex_id, arc> const& a, vertex_id w )
+{
+    return a.first < w;
+}
+
+// Set the edge to w in arcs to a, adding it if it is not there
+void set_arc( arcs_t& arcs, vertex_id w, arc a )
+{
+    arcs_t::iterator i = std::lower_bound( arcs.begin(), arcs.end(), w, arc_before );
+    if ( i != arcs.end() && i->first == w )
+        i->second = a;
+    else
+        arcs.insert( i, std::make_pair( w, a ) );
+}
+
+// Remove the edge to w from arcs; it must be there
+void erase_arc( arcs_t& arcs, vertex_id w )
+{
+    arcs_t::iterator i = std::lower_bound( arcs.begin(), arcs.end(), w, arc_before );
+    assert( i != arcs.end() && i->first == w );
+    arcs.erase( i );
+}
+
+// The state of contraction: the remaining graph with its shortcuts,
+// in both directions, and scratch space for witness searches
+struct contraction_state
+{
+    std::vector<arcs_t> out, in;
+    std::vector<bool> contracted;
+    std::vector<unsigned> contracted_neighbors;
+
+    // Witness search labels: dist[v] and hops[v] are valid iff
+    // stamp[v] == epoch, and v is one of the search's targets iff
+    // target[v] == epoch
+    std::vector<edge_weight> dist;
+    std::vector<unsigned> hops, stamp, target;
+    unsigned epoch;
+    std::vector<std::pair<edge_weight, vertex_id> > queue;
+    std::size_t witness_limit;
+};
+
+// Add an edge u -> w to s's remaining graph, or lower its weight if it
+// is already there with a greater one
+void add_arc( contraction_state& s, vertex_id u, vertex_id w, edge_weight weight, vertex_id middle )
+{
+    arcs_t::const_iterator i = std::lower_bound( s.out[u].begin(), s.out[u].end(), w, arc_before );
+    if ( i != s.out[u].end() && i->first == w && !(weight < i->second.weight) )
+        return;
+
+    arc a = { weight, middle };
+    set_arc( s.out[u], w, a );
+    set_arc( s.in[w], u, a );
+}
+
+// Run a Dijkstra search from u in s's remaining graph, avoiding v and
+// following paths of at most hop_limit edges, until every vertex
+// within limit is settled, every out-neighbor of v is, or
+// witness_limit vertices have been.  Afterwards witness_distance( s, w )
+// is an upper bound on the distance from u to w without passing
+// through v.
+void witness_search(
+    contraction_state& s, vertex_id u, vertex_id v, edge_weight limit, unsigned hop_limit )
+{
+    if ( ++s.epoch == 0 )
+    {
+        std::fill( s.stamp.begin(), s.stamp.end(), 0 );
+        std::fill( s.target.begin(), s.target.end(), 0 );
+        s.epoch = 1;
+    }
+
+    std::size_t targets = 0;
+    for ( arcs_t::const_iterator b = s.out[v].begin(); b != s.out[v].end(); ++b )
+        if ( b->first != u )
+        {
+            s.target[b->first] = s.epoch;
+            ++targets;
+        }
+
+    typedef std::pair<edge_weight, vertex_id> entry;
+    std::vector<entry>& q = s.queue;
+    q.clear();
+    s.dist[u] = 0;
+    s.hops[u] = 0;
+    s.stamp[u] = s.epoch;
+    q.push_back( entry( 0, u ) );
+
+    for ( std::size_t settled = 0; targets != 0 && !q.empty() && settled < s.witness_limit; )
+    {
+        std::pop_heap( q.begin(), q.end(), std::greater<entry>() );
+        entry e = q.back();
+        q.pop_back();
+        if ( e.first > s.dist[e.second] )
+            continue;   // a stale entry
+        if ( e.first > limit )
+            break;
+        ++settled;
+        targets -= s.target[e.second] == s.epoch;
+        if ( s.hops[e.second] == hop_limit )
+            continue;
+
+        for ( arcs_t::const_iterator a = s.out[e.second].begin(), last = s.out[e.second].end();
+              a != last; ++a )
+        {
+            vertex_id x = a->first;
+            edge_weight d = e.first + a->second.weight;
+            if ( x != v && !(d > limit) && (s.stamp[x] != s.epoch || d < s.dist[x]) )
+            {
+                s.dist[x] = d;
+                s.hops[x] = s.hops[e.second] + 1;
+                s.stamp[x] = s.epoch;
+                q.push_back( entry( d, x ) );
+                std::push_heap( q.begin(), q.end(), std::greater<entry>() );
+            }
+        }
+    }
+}
+
+inline edge_weight witness_distance( contraction_state const& s, vertex_id w )
+{
+    return s.stamp[w] == s.epoch ? s.dist[w] : infinity;
+}
+
+// A shortcut u -> w through the vertex being contracted
+struct shortcut
+{
+    vertex_id from;
+    vertex_id to;
+    edge_weight weight;
+};
+
+// Set shortcuts to the shortcuts contracting v from s's remaining
+// graph needs, as far as witness searches of hop_limit hops can tell
+void find_shortcuts(
+    contraction_state& s, vertex_id v, unsigned hop_limit, std::vector<shortcut>& shortcuts )
+{
+    shortcuts.clear();
+    edge_weight max_out = 0;
+    for ( arcs_t::const_iterator b = s.out[v].begin(); b != s.out[v].end(); ++b )
+        max_out = std::max( max_out, b->second.weight );
+
+    for ( arcs_t::const_iterator a = s.in[v].begin(); a != s.in[v].end(); ++a )
+    {
+        vertex_id u = a->first;
+        witness_search( s, u, v, a->second.weight + max_out, hop_limit );
+        for ( arcs_t::const_iterator b = s.out[v].begin(); b != s.out[v].end(); ++b )
+        {
+            vertex_id w = b->first;
+            edge_weight through_v = a->second.weight + b->second.weight;
+            if ( w == u || witness_distance( s, w ) <= through_v )
+                continue;
+            shortcut sc = { u, w, through_v };
+            shortcuts.push_back( sc );
+        }
+    }
+}
+
+// The contraction priority of v: lower is contracted sooner.  Sets
+// shortcuts to those contracting v would add, as find_shortcuts does.
+inline long importance(
+    contraction_state& s, vertex_id v, unsigned hop_limit, std::vector<shortcut>& shortcuts )
+{
+    find_shortcuts( s, v, hop_limit, shortcuts );
+    long removed = s.in[v].size() + s.out[v].size();
+    return long( shortcuts.size() ) - removed + s.contracted_neighbors[v];
+}
+
+// Build a contraction hierarchy of g.  Witness searches give up after
+// settling witness_limit vertices, and ignore paths of more than
+// hop_limit edges; either may add shortcuts that are not needed but
+// never loses a shortest path.  The importance of vertices in the
+// queue is only estimated, with searches of update_hop_limit hops; it
+// is computed in full when a vertex reaches the front, and the
+// shortcuts found then are the ones added.
+// Requires: every weight in g is non-negative; both limits are positive
+// Complexity: depends on the graph; near-linear on road networks
+contraction_hierarchy make_contraction_hierarchy(
+    graph const& g, std::size_t witness_limit = 500, unsigned hop_limit = 8,
+    unsigned update_hop_limit = 2 )
+{
+    assert( hop_limit > 0 && update_hop_limit > 0 );
+    std::size_t const n = count_vertices( g );
+    contraction_state s;
+    s.out.resize( n );
+    s.in.resize( n );
+    s.contracted.resize( n );
+    s.contracted_neighbors.resize( n );
+    s.dist.resize( n );
+    s.hops.resize( n );
+    s.stamp.resize( n );
+    s.target.resize( n );
+    s.epoch = 0;
+    s.witness_limit = witness_limit;
+
+    for ( vertex_id u = 0; u < n; ++u )
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+        {
+            assert( p->second >= 0 );
+            if ( p->first != u )
+                add_arc( s, u, p->first, p->second, no_vertex );
+        }
+
+    // priority[v] is v's current importance; queue entries that
+    // disagree with it are stale
+    typedef std::pair<long, vertex_id> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry> > q;
+    std::vector<long> priority( n );
+    std::vector<shortcut> shortcuts;
+    for ( vertex_id v = 0; v < n; ++v )
+    {
+        priority[v] = importance( s, v, update_hop_limit, shortcuts );
+        q.push( entry( priority[v], v ) );
+    }
+
+    contraction_hierarchy h;
+    h.rank.resize( n );
+    std::vector<std::vector<ch_edge> > up( n ), down( n );
+    for ( unsigned next_rank = 0; !q.empty(); )
+    {
+        entry top = q.top();
+        vertex_id v = top.second;
+        q.pop();
+        if ( s.contracted[v] || top.first != priority[v] )
+            continue;
+
+        // Contractions further away can change v's importance too; if
+        // it has risen past the next candidate's, put v back.  The
+        // shortcuts found on the way are the ones contracting v needs.
+        priority[v] = importance( s, v, hop_limit, shortcuts );
+        if ( !q.empty() && priority[v] > q.top().first )
+        {
+            q.push( entry( priority[v], v ) );
+            continue;
+        }
+
+        for ( std::size_t i = 0; i < shortcuts.size(); ++i )
+            add_arc( s, shortcuts[i].from, shortcuts[i].to, shortcuts[i].weight, v );
+        h.rank[v] = next_rank++;
+        s.contracted[v] = true;
+
+        for ( arcs_t::const_iterator b = s.out[v].begin(); b != s.out[v].end(); ++b )
+        {
+            ch_edge e = { b->first, b->second.weight, b->second.middle };
+            up[v].push_back( e );
+            erase_arc( s.in[b->first], v );
+            ++s.contracted_neighbors[b->first];
+        }
+        for ( arcs_t::const_iterator a = s.in[v].begin(); a != s.in[v].end(); ++a )
+        {
+            ch_edge e = { a->first, a->second.weight, a->second.middle };
+            down[v].push_back( e );
+            erase_arc( s.out[a->first], v );
+            ++s.contracted_neighbors[a->first];
+        }
+
+        // The neighbors' importance has changed the most
+        std::vector<vertex_id> neighbors;
+        for ( std::size_t i = 0; i < up[v].size(); ++i )
+            neighbors.push_back( up[v][i].target );
+        for ( std::size_t i = 0; i < down[v].size(); ++i )
+            neighbors.push_back( down[v][i].target );
+        std::sort( neighbors.begin(), neighbors.end() );
+        neighbors.erase( std::unique( neighbors.begin(), neighbors.end() ), neighbors.end() );
+        for ( std::size_t i = 0; i < neighbors.size(); ++i )
+        {
+            vertex_id x = neighbors[i];
+            priority[x] = importance( s, x, update_hop_limit, shortcuts );
+            q.push( entry( priority[x], x ) );
+        }
+
+        arcs_t().swap( s.out[v] );
+        arcs_t().swap( s.in[v] );
+    }
+
+    // The arcs were ordered by target, so each range is sorted
+    h.up_offsets.push_back( 0 );
+    h.down_offsets.push_back( 0 );
+    for ( vertex_id v = 0; v < n; ++v )
+    {
+        h.up.insert( h.up.end(), up[v].begin(), up[v].end() );
+        h.up_offsets.push_back( h.up.size() );
+        h.down.insert( h.down.end(), down[v].begin(), down[v].end() );
+        h.down_offsets.push_back( h.down.size() );
+    }
+    return h;
+}
+
+// Return the number of shortcuts in h
+std::size_t count_shortcuts( contraction_hierarchy const& h )
+{
+    std::size_t count = 0;
+    for ( std::size_t i = 0; i < h.up.size(); ++i )
+        count += h.up[i].middle != no_vertex;
+    for ( std::size_t i = 0; i < h.down.size(); ++i )
+        count += h.down[i].middle != no_vertex;
+    return count;
+}
+
+// The label a hierarchy query gives a vertex in one direction: its
+// distance, the vertex before it, and the vertex the edge between them
+// bypasses.  It is valid only if epoch is the current query's.
+struct ch_label
+{
+    edge_weight d;
+    vertex_id p;
+    vertex_id middle;
+    unsigned epoch;
+};
+
+// One direction of a hierarchy query
+struct ch_side
+{
+    std::vector<ch_label> labels;
+    indexed_heap<> q;
+};
+
+// Scratch space for hierarchy queries, reused from one query to the
+// next so each costs time for the vertices it touches, not O( |V| )
+struct ch_workspace
+{
+    ch_workspace() : epoch( 0 ) {}
+
+    // Begin a query on a hierarchy of n vertices
+    void start( std::size_t n )
+    {
+        ch_side* sides[2] = { &forward, &backward };
+        for ( int i = 0; i < 2; ++i )
+        {
+            ch_label none = { infinity, no_vertex, no_vertex, 0 };
+            if ( sides[i]->labels.size() < n )
+                sides[i]->labels.resize( n, none );
+            sides[i]->q.reset( n );
+        }
+        if ( ++epoch == 0 )
+        {
+            for ( int i = 0; i < 2; ++i )
+                for ( std::size_t v = 0; v < sides[i]->labels.size(); ++v )
+                    sides[i]->labels[v].epoch = 0;
+            epoch = 1;
+        }
+    }
+
+    ch_side forward, backward;
+    unsigned epoch;
+};
+
+// Return the distance side has found to v in the query of epoch
+inline edge_weight distance( ch_side const& side, unsigned epoch, vertex_id v )
+{
+    return side.labels[v].epoch == epoch ? side.labels[v].d : infinity;
+}
+
+// Settle the head of near's queue and relax its edges in offsets and
+// edges.  If far has reached the settled vertex, lower mu to the
+// length of the path through it if that is shorter, recording the
+// vertex in meet.
+void settle_next(
+    ch_side& near, ch_side const& far, unsigned epoch,
+    std::vector<std::uint64_t> const& offsets, std::vector<ch_edge> const& edges,
+    edge_weight& mu, vertex_id& meet )
+{
+    vertex_id const u = near.q.pop();
+    edge_weight const du = near.labels[u].d;
+    if ( du + distance( far, epoch, u ) < mu )
+    {
+        mu = du + distance( far, epoch, u );
+        meet = u;
+    }
+
+    for ( std::uint64_t i = offsets[u]; i < offsets[u + 1]; ++i )
+    {
+        ch_edge const& e = edges[i];
+        edge_weight x = du + e.weight;
+        if ( x < distance( near, epoch, e.target ) )
+        {
+            ch_label l = { x, u, e.middle, epoch };
+            near.labels[e.target] = l;
+            near.q.push_or_decrease( e.target, x );
+        }
+    }
+}
+
+// Append to path the vertices after a on the original edges that
+// the edge a -> b bypassing middle stands for, ending with b
+void unpack_edge(
+    contraction_hierarchy const& h, vertex_id a, vertex_id b, vertex_id middle,
+    std::vector<vertex_id>& path )
+{
+    ch_edge const top = { b, 0, middle };
+    std::vector<std::pair<vertex_id, ch_edge> > stack( 1, std::make_pair( a, top ) );
+    while ( !stack.empty() )
+    {
+        vertex_id x = stack.back().first;
+        ch_edge e = stack.back().second;
+        stack.pop_back();
+        if ( e.middle == no_vertex )
+        {
+            path.push_back( e.target );
+            continue;
+        }
+
+        // x -> m is a downward edge stored at m, m -> y an upward one;
+        // push the second half first so the first is unpacked first
+        vertex_id m = e.middle;
+        stack.push_back( std::make_pair( m, find_edge( h.up_offsets, h.up, m, e.target ) ) );
+        ch_edge first = find_edge( h.down_offsets, h.down, m, x );
+        first.target = m;
+        stack.push_back( std::make_pair( x, first ) );
+    }
+}
+
+// Compute the shortest path from s to dst with hierarchy h, writing
+// the ids of vertices on the path (excluding s), in reverse order,
+// into out_path.  Return a pair consisting of the total path cost and
+// the resulting value of out_path.  If dst is not reachable the cost
+// is infinity and nothing is written.  Same contract as poor_dijkstra.
+// w supplies scratch space, and settled is set to the number of
+// vertices the two searches settled.
+template <class OutputIterator>
+std::pair<edge_weight,OutputIterator>
+ch_query(
+    contraction_hierarchy const& h, vertex_id s, vertex_id dst, OutputIterator out_path,
+    ch_workspace& w, std::size_t& settled )
+{
+    std::size_t const n = count_vertices( h );
+    assert( s < n && dst < n );
+
+    w.start( n );
+    ch_label const start = { 0, no_vertex, no_vertex, w.epoch };
+    w.forward.labels[s] = start;
+    w.forward.q.push_or_decrease( s, 0 );
+    w.backward.labels[dst] = start;
+    w.backward.q.push_or_decrease( dst, 0 );
+
+    // Each search stops once its nearest unsettled vertex is no closer
+    // than the best path found
+    edge_weight mu = infinity;
+    vertex_id meet = no_vertex;
+    for ( settled = 0; ; ++settled )
+    {
+        bool forward = !w.forward.q.empty() && w.forward.q.top_key() < mu;
+        bool backward = !w.backward.q.empty() && w.backward.q.top_key() < mu;
+        if ( forward && backward )
+            forward = w.forward.q.top_key() <= w.backward.q.top_key();
+        else if ( !forward && !backward )
+            break;
+
+        if ( forward )
+            settle_next( w.forward, w.backward, w.epoch, h.up_offsets, h.up, mu, meet );
+        else
+            settle_next( w.backward, w.forward, w.epoch, h.down_offsets, h.down, mu, meet );
+    }
+    if ( mu == infinity )
+        return std::make_pair( mu, out_path );
+
+    // The path in hierarchy edges runs from s up to meet, then down
+    // to dst; unpack each edge in order
+    std::vector<vertex_id> up_half( 1, meet );
+    while ( up_half.back() != s )
+        up_half.push_back( w.forward.labels[up_half.back()].p );
+
+    std::vector<vertex_id> path( 1, s );
+    for ( std::size_t i = up_half.size() - 1; i > 0; --i )
+        unpack_edge( h, up_half[i], up_half[i - 1], w.forward.labels[up_half[i - 1]].middle, path );
+    for ( vertex_id x = meet; x != dst; x = w.backward.labels[x].p )
+        unpack_edge( h, x, w.backward.labels[x].p, w.backward.labels[x].middle, path );
+
+    out_path = std::copy( path.rbegin(), path.rend() - 1, out_path );
+    return std::make_pair( mu, out_path );
+}
+
+template <class OutputIterator>
+std::pair<edge_weight,OutputIterator>
+ch_query( contraction_hierarchy const& h, vertex_id s, vertex_id dst, OutputIterator out_path )
+{
+    ch_workspace w;
+    std::size_t settled;
+    return ch_query( h, s, dst, out_path, w, settled );
+}
+
+// A fixed set of threads that repeatedly run a job together.  run(f)
+// calls f(t) once on each thread t in [0, size()), with the calling
+// thread acting as thread 0, and returns when every call has.
+class thread_pool
+{
+ public:
+    explicit thread_pool( unsigned n )
+        : size_( std::max( 1u, n ) ), generation_(0), running_(0), stopping_(false)
+    {
+        for ( unsigned t = 1; t < size_; ++t )
+            workers_.push_back( std::thread( &thread_pool::work, this, t ) );
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            stopping_ = true;
+        }
+        start_.notify_all();
+        for ( unsigned t = 0; t < workers_.size(); ++t )
+            workers_[t].join();
+    }
+
+    thread_pool( thread_pool const& ) = delete;
+    thread_pool& operator=( thread_pool const& ) = delete;
+
+    unsigned size() const { return size_; }
+
+    void run( std::function<void( unsigned )> const& f )
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            job_ = &f;
+            running_ = size_ - 1;
+            ++generation_;
+        }
+        start_.notify_all();
+        f( 0 );
+
+        std::unique_lock<std::mutex> lock( mutex_ );
+        done_.wait( lock, [this] { return running_ == 0; } );
+    }
+
+ private:
+    void work( unsigned t )
+    {
+        for ( unsigned long seen = 0; ; )
+        {
+            std::function<void( unsigned )> const* job;
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                start_.wait( lock, [&] { return stopping_ || generation_ != seen; } );
+                if ( stopping_ )
+                    return;
+                seen = generation_;
+                job = job_;
+            }
+            (*job)( t );
+            {
+                std::lock_guard<std::mutex> lock( mutex_ );
+                if ( --running_ == 0 )
+                    done_.notify_one();
+            }
+        }
+    }
+
+    unsigned size_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_, done_;
+    std::function<void( unsigned )> const* job_;
+    unsigned long generation_;
+    unsigned running_;
+    bool stopping_;
+};
+
+// Settle every vertex reachable from s over the edges in offsets and
+// edges, calling visit( x, d ) with the distance d of each settled x
+// that the search does not stall.  With h's upward edges these are
+// the labels a query's forward search could settle; with its downward
+// edges, the backward search's.
+//
+// Stall-on-demand: stall_offsets and stall_edges hold the edges into
+// each vertex from higher ranks.  If one of them gives x a shorter
+// path than the search has, x's label is not a shortest distance, so
+// x neither reports it nor relaxes its edges.
+template <class Visit>
+void upward_search(
+    ch_workspace& w, std::size_t n,
+    std::vector<std::uint64_t> const& offsets, std::vector<ch_edge> const& edges,
+    std::vector<std::uint64_t> const& stall_offsets, std::vector<ch_edge> const& stall_edges,
+    vertex_id s, Visit visit )
+{
+    w.start( n );
+    ch_label const start = { 0, no_vertex, no_vertex, w.epoch };
+    w.forward.labels[s] = start;
+    w.forward.q.push_or_decrease( s, 0 );
+
+    // w.backward stays empty, so settle_next never finds a meeting
+    edge_weight mu = infinity;
+    vertex_id meet = no_vertex;
+    while ( !w.forward.q.empty() )
+    {
+        vertex_id const x = w.forward.q.top();
+        edge_weight const dx = w.forward.q.top_key();
+        bool stalled = false;
+        for ( std::uint64_t i = stall_offsets[x]; i < stall_offsets[x + 1] && !stalled; ++i )
+            stalled = distance( w.forward, w.epoch, stall_edges[i].target ) + stall_edges[i].weight < dx;
+
+        if ( stalled )
+            w.forward.q.pop();
+        else
+        {
+            visit( x, dx );
+            settle_next( w.forward, w.backward, w.epoch, offsets, edges, mu, meet );
+        }
+    }
+}
+
+// An entry in the bucket of a vertex x: the distance from x to the
+// target with index target
+struct bucket_entry
+{
+    unsigned target;
+    edge_weight d;
+};
+
+// Return the distance from each of sources to each of targets with
+// hierarchy h, as a dense row-major matrix: element
+// i * targets.size() + j is the distance from sources[i] to
+// targets[j], or infinity if there is no path.  No paths are recorded;
+// ch_query finds the path for any entry that needs one.
+//
+// Many-to-many search (Knopp, Sanders, Schultes, Schulz & Wagner,
+// "Computing Many-to-Many Shortest Paths Using Highway Hierarchies",
+// ALENEX 2007): the backward search from each target leaves its
+// distance in the bucket of every vertex it settles, then the forward
+// search from each source scans the buckets of the vertices it
+// settles.  A shortest path's highest-ranked vertex is settled by
+// both, so each pair costs a bucket entry instead of a search.  The
+// searches of each phase are shared out to pool's threads chunk
+// searches at a time.
+// Requires: chunk > 0
+//
+// Complexity: O( (|S| + |T|) x upward search + bucket entries scanned
+// + |V| + |S| x |T| )
+std::vector<edge_weight> distance_table(
+    thread_pool& pool, contraction_hierarchy const& h,
+    std::vector<vertex_id> const& sources, std::vector<vertex_id> const& targets,
+    std::size_t chunk = 16 )
+{
+    assert( chunk > 0 );
+    std::size_t const n = count_vertices( h ), columns = targets.size();
+    std::vector<ch_workspace> workspaces( pool.size() );
+    std::atomic<std::size_t> index( 0 );
+
+    // Each thread collects the entries of the targets it takes, with
+    // the vertex whose bucket each belongs in
+    typedef std::pair<vertex_id, bucket_entry> placed_entry;
+    std::vector<std::vector<placed_entry> > placed( pool.size() );
+    pool.run( [&]( unsigned t ) {
+        for ( std::size_t first; (first = index.fetch_add( chunk )) < columns; )
+        {
+            for ( std::size_t j = first, last = std::min( first + chunk, columns ); j < last; ++j )
+            {
+                assert( targets[j] < n );
+                upward_search(
+                    workspaces[t], n, h.down_offsets, h.down, h.up_offsets, h.up, targets[j],
+                    [&]( vertex_id x, edge_weight d ) {
+                        bucket_entry e = { unsigned( j ), d };
+                        placed[t].push_back( placed_entry( x, e ) );
+                    } );
+            }
+        }
+    } );
+
+    // Bucket x is buckets[offsets[x]] .. buckets[offsets[x+1]-1]
+    std::vector<std::size_t> offsets( n + 1 );
+    for ( std::size_t t = 0; t < placed.size(); ++t )
+        for ( std::size_t i = 0; i < placed[t].size(); ++i )
+            ++offsets[placed[t][i].first + 1];
+    std::partial_sum( offsets.begin(), offsets.end(), offsets.begin() );
+    std::vector<bucket_entry> buckets( offsets[n] );
+    std::vector<std::size_t> fill( offsets.begin(), offsets.end() - 1 );
+    for ( std::size_t t = 0; t < placed.size(); ++t )
+    {
+        for ( std::size_t i = 0; i < placed[t].size(); ++i )
+            buckets[fill[placed[t][i].first]++] = placed[t][i].second;
+        std::vector<placed_entry>().swap( placed[t] );
+    }
+
+    // Only the thread that takes source i writes row i
+    std::vector<edge_weight> table( sources.size() * columns, infinity );
+    index.store( 0 );
+    pool.run( [&]( unsigned t ) {
+        for ( std::size_t first; (first = index.fetch_add( chunk )) < sources.size(); )
+        {
+            for ( std::size_t i = first, last = std::min( first + chunk, sources.size() ); i < last; ++i )
+            {
+                assert( sources[i] < n );
+                edge_weight* row = table.data() + i * columns;
+                upward_search(
+                    workspaces[t], n, h.up_offsets, h.up, h.down_offsets, h.down, sources[i],
+                    [&]( vertex_id x, edge_weight d ) {
+                        for ( std::size_t k = offsets[x]; k < offsets[x + 1]; ++k )
+                            row[buckets[k].target] = std::min( row[buckets[k].target], d + buckets[k].d );
+                    } );
+            }
+        }
+    } );
+    return table;
+}
+
+// The header of a saved hierarchy.  The rank, upward offsets, upward
+// edges, downward offsets and downward edges arrays follow in that
+// order, each as raw machine words.
+struct hierarchy_file_header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t vertex_count;
+    std::uint64_t up_count;
+    std::uint64_t down_count;
+};
+
+char const hierarchy_file_magic[8] = { 'L', 'A', 'B', 'C', 'H', 'I', 'E', 'R' };
+std::uint32_t const hierarchy_file_version = 1;
+std::uint32_t const hierarchy_file_byte_order = 0x01020304;
+
+template <class T>
+void write_array( std::ostream& output, std::vector<T> const& a )
+{
+    output.write( reinterpret_cast<char const*>( a.data() ), a.size() * sizeof( T ) );
+}
+
+// Read size elements into a from input, where remaining bytes of
+// input are left; fail without reading if they cannot all be there
+template <class T>
+bool read_array( std::istream& input, std::vector<T>& a, std::uint64_t size, std::uint64_t& remaining )
+{
+    if ( size > remaining / sizeof( T ) )
+        return false;
+    remaining -= size * sizeof( T );
+    a.resize( size );
+    return bool( input.read( reinterpret_cast<char*>( a.data() ), size * sizeof( T ) ) );
+}
+
+// True iff there is an edge of the given target among v's edges in
+// offsets and edges, which must be sorted by target
+bool has_target(
+    std::vector<std::uint64_t> const& offsets, std::vector<ch_edge> const& edges,
+    vertex_id v, vertex_id target )
+{
+    std::vector<ch_edge>::const_iterator last = edges.begin() + offsets[v + 1];
+    std::vector<ch_edge>::const_iterator e = std::lower_bound( edges.begin() + offsets[v], last, target );
+    return e != last && e->target == target;
+}
+
+// True iff offsets delimit edges for every vertex of h, and each
+// vertex's edges are sorted by target, lead to higher ranks, and
+// bypass only lower ranks
+bool valid_edges(
+    contraction_hierarchy const& h,
+    std::vector<std::uint64_t> const& offsets, std::vector<ch_edge> const& edges )
+{
+    std::size_t const n = count_vertices( h );
+    if ( offsets.size() != n + 1 || offsets.front() != 0 || offsets.back() != edges.size() )
+        return false;
+    for ( vertex_id v = 0; v < n; ++v )
+        if ( offsets[v] > offsets[v + 1] )
+            return false;
+
+    for ( vertex_id v = 0; v < n; ++v )
+    {
+        for ( std::uint64_t i = offsets[v]; i < offsets[v + 1]; ++i )
+        {
+            ch_edge const& e = edges[i];
+            if ( e.target >= n || h.rank[e.target] <= h.rank[v]
+                 || (i > offsets[v] && !(edges[i - 1].target < e.target))
+                 || (e.middle != no_vertex && (e.middle >= n || h.rank[e.middle] >= h.rank[v])) )
+                return false;
+        }
+    }
+    return true;
+}
+
+// True iff h is consistent: rank is a permutation, the edges pass
+// valid_edges, and both halves of every shortcut are there.  Queries
+// on such a hierarchy stay in bounds, and unpacking a shortcut ends,
+// since each half's bypassed vertex ranks lower still.
+bool is_valid_hierarchy( contraction_hierarchy const& h )
+{
+    std::size_t const n = count_vertices( h );
+    std::vector<bool> used( n );
+    for ( vertex_id v = 0; v < n; ++v )
+    {
+        if ( h.rank[v] >= n || used[h.rank[v]] )
+            return false;
+        used[h.rank[v]] = true;
+    }
+    if ( !valid_edges( h, h.up_offsets, h.up ) || !valid_edges( h, h.down_offsets, h.down ) )
+        return false;
+
+    // An upward v -> w bypassing m is v -> m stored downward at m and
+    // m -> w upward; a downward w -> v likewise is w -> m and m -> v
+    for ( vertex_id v = 0; v < n; ++v )
+    {
+        for ( std::uint64_t i = h.up_offsets[v]; i < h.up_offsets[v + 1]; ++i )
+        {
+            vertex_id m = h.up[i].middle;
+            if ( m != no_vertex
+                 && !(has_target( h.down_offsets, h.down, m, v )
+                      && has_target( h.up_offsets, h.up, m, h.up[i].target )) )
+                return false;
+        }
+        for ( std::uint64_t i = h.down_offsets[v]; i < h.down_offsets[v + 1]; ++i )
+        {
+            vertex_id m = h.down[i].middle;
+            if ( m != no_vertex
+                 && !(has_target( h.down_offsets, h.down, m, h.down[i].target )
+                      && has_target( h.up_offsets, h.up, m, v )) )
+                return false;
+        }
+    }
+    return true;
+}
+
+// Save h to path
+void write_hierarchy( std::string const& path, contraction_hierarchy const& h )
+{
+    std::ofstream output( path.c_str(), std::ios::binary | std::ios::trunc );
+    if ( !output )
+        throw std::runtime_error( "cannot create " + path );
+
+    hierarchy_file_header header;
+    std::memset( &header, 0, sizeof( header ) );
+    std::memcpy( header.magic, hierarchy_file_magic, sizeof( header.magic ) );
+    header.version = hierarchy_file_version;
+    header.byte_order = hierarchy_file_byte_order;
+    header.vertex_count = h.rank.size();
+    header.up_count = h.up.size();
+    header.down_count = h.down.size();
+
+    output.write( reinterpret_cast<char const*>( &header ), sizeof( header ) );
+    write_array( output, h.rank );
+    write_array( output, h.up_offsets );
+    write_array( output, h.up );
+    write_array( output, h.down_offsets );
+    write_array( output, h.down );
+    if ( !output.flush() )
+        throw std::runtime_error( "cannot write " + path );
+}
+
+// Load a hierarchy saved by write_hierarchy from path.  The file is
+// checked in full, so a corrupt one is rejected rather than trusted.
+contraction_hierarchy read_hierarchy( std::string const& path )
+{
+    std::ifstream input( path.c_str(), std::ios::binary );
+    if ( !input )
+        throw std::runtime_error( "cannot open " + path );
+
+    hierarchy_file_header header;
+    if ( !input.read( reinterpret_cast<char*>( &header ), sizeof( header ) )
+         || std::memcmp( header.magic, hierarchy_file_magic, sizeof( header.magic ) ) != 0 )
+        throw std::runtime_error( path + " is not a contraction hierarchy file" );
+    if ( header.version != hierarchy_file_version
+         || header.byte_order != hierarchy_file_byte_order )
+        throw std::runtime_error( path + " is not a version 1 contraction hierarchy file" );
+
+    // No array may claim more elements than the bytes left could hold
+    std::streamoff const here = input.tellg();
+    input.seekg( 0, std::ios::end );
+    std::uint64_t remaining = std::uint64_t( input.tellg() - here );
+    input.seekg( here );
+
+    contraction_hierarchy h;
+    if ( header.vertex_count >= no_vertex
+         || !read_array( input, h.rank, header.vertex_count, remaining )
+         || !read_array( input, h.up_offsets, header.vertex_count + 1, remaining )
+         || !read_array( input, h.up, header.up_count, remaining )
+         || !read_array( input, h.down_offsets, header.vertex_count + 1, remaining )
+         || !read_array( input, h.down, header.down_count, remaining )
+         || remaining != 0
+         || !is_valid_hierarchy( h ) )
+        throw std::runtime_error( path + " is truncated or corrupt" );
+    return h;
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = add_vertex( g );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + count_adj(g, src)) * 1.0 / count_vertices(g);
+            add_edge( g, src, dst, w );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << '\n';
+    }
+}
+
+#include <iostream>
+// Answer a query from u to v with h and print the path and statistics
+void print_query( contraction_hierarchy const& h, vertex_id u, vertex_id v )
+{
+    ch_workspace w;
+    std::size_t settled;
+    std::cout << "reverse shortest path: ";
+    edge_weight length = ch_query(
+        h, u, v, std::ostream_iterator<vertex_id>( std::cout, " " ), w, settled ).first;
+    std::cout << "has length: " << length << std::endl;
+    std::cout << "settled vertices: " << settled << std::endl;
+}
+
+// Print the distances between every two of vertices, computed with h
+void print_table( contraction_hierarchy const& h, std::vector<vertex_id> const& vertices )
+{
+    thread_pool pool( std::thread::hardware_concurrency() );
+    std::vector<edge_weight> table = distance_table( pool, h, vertices, vertices );
+    std::cout << "distance table (" << pool.size() << " threads):" << std::endl;
+    for ( std::size_t i = 0; i < vertices.size(); ++i )
+    {
+        std::cout << "from " << vertices[i] << ":";
+        for ( std::size_t j = 0; j < vertices.size(); ++j )
+            std::cout << ' ' << table[i * vertices.size() + j];
+        std::cout << std::endl;
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    bool writing = argc > 1 && std::string( argv[1] ) == "write";
+    bool tabling = argc > 1 && std::string( argv[1] ) == "table";
+    bool loading = !writing && !tabling && argc == 4;
+    if ( writing ? argc != 3 : !tabling && argc != 3 && argc != 4 )
+    {
+        std::cerr << "usage: " << argv[0] << " u v < adjacency-list" << std::endl
+                  << "       " << argv[0] << " table v... < adjacency-list" << std::endl
+                  << "       " << argv[0] << " write FILE < adjacency-list" << std::endl
+                  << "       " << argv[0] << " FILE u v" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        contraction_hierarchy h;
+        if ( loading )
+            h = read_hierarchy( argv[1] );
+        else
+        {
+            graph g;
+            read_adjacency_list( std::cin, g );
+            if ( !writing )
+                write_adjacency_matrix( std::cout, g );
+
+            typedef std::chrono::steady_clock clock;
+            clock::time_point start = clock::now();
+            h = make_contraction_hierarchy( g );
+            double build_ms = std::chrono::duration<double, std::milli>( clock::now() - start ).count();
+
+            if ( writing )
+            {
+                write_hierarchy( argv[2], h );
+                return 0;
+            }
+            if ( tabling )
+            {
+                std::vector<vertex_id> vertices( argc - 2 );
+                for ( int i = 2; i < argc; ++i )
+                    std::stringstream(argv[i]) >> vertices[i - 2];
+                print_table( h, vertices );
+                return 0;
+            }
+
+            vertex_id u, v;
+            std::stringstream(argv[1]) >> u;
+            std::stringstream(argv[2]) >> v;
+            print_query( h, u, v );
+            std::cout << "hierarchy: " << count_shortcuts( h ) << " shortcuts, built in "
+                      << build_ms << " ms" << std::endl;
+            return 0;
+        }
+
+        vertex_id u, v;
+        std::stringstream(argv[2]) >> u;
+        std::stringstream(argv[3]) >> v;
+        print_query( h, u, v );
+    }
+    catch ( std::exception const& e )
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
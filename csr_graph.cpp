@@ -0,0 +1,339 @@
+/*
+    g++ csr_graph.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 2 0
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    common neighbors of vertices 2 and 0:
+    vertex 0 is reachable from vertex 2
+    reverse shortest path: 0 3 4 has length: 0.783333
+
+Notes:
+compressed sparse row (CSR) layout
+offsets[u]..offsets[u+1] is the range of u's edges in targets/weights
+every traversal is a sequential scan of contiguous memory
+
+ */
+#define _GLIBCXX_DEBUG
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <deque>
+#include <queue>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+#include <map>
+
+typedef unsigned vertex_id;
+typedef float edge_weight;
+
+// Edge list graph representation (see edge_list_solution.cpp)
+typedef std::pair<vertex_id, vertex_id> edge;
+typedef std::vector<edge> edge_list;
+
+// Adjacency list graph representation (see edge_list_solution.cpp)
+typedef std::vector<vertex_id> neighbors_t;
+typedef std::vector<neighbors_t> adjacency_list;
+
+// Weighted adjacency list graph representation (see map_bfs_solution.cpp)
+typedef std::map<vertex_id, edge_weight> weighted_neighbors_t;
+typedef std::vector<weighted_neighbors_t> graph;
+
+// Compressed sparse row graph representation.  The edges leaving u
+// are targets[offsets[u]] .. targets[offsets[u+1]-1], sorted by
+// target, with the weight of each edge at the same index in weights.
+// There are count_vertices(g) + 1 offsets; the last one is |E|.
+struct csr_graph
+{
+    // An empty graph: no vertices, and the single offset 0
+    csr_graph() : offsets( 1, 0 ) {}
+
+    std::vector<std::size_t> offsets;
+    std::vector<vertex_id> targets;
+    std::vector<edge_weight> weights;
+};
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( csr_graph const& g )
+{
+    return g.offsets.size() - 1;
+}
+
+// Return the number of outgoing edges from u in g
+// Complexity: O( 1 )
+inline std::size_t count_adj( csr_graph const& g, vertex_id u )
+{
+    return g.offsets[u + 1] - g.offsets[u];
+}
+
+// Return the first and past-the-end positions of u's targets in g
+inline std::pair<vertex_id const*, vertex_id const*>
+adjacent_vertices( csr_graph const& g, vertex_id u )
+{
+    vertex_id const* base = g.targets.empty() ? 0 : &g.targets[0];
+    return std::make_pair( base + g.offsets[u], base + g.offsets[u + 1] );
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(count_adj(g, u)) )
+inline bool has_edge( csr_graph const& g, int u, int v )
+{
+    std::pair<vertex_id const*, vertex_id const*> adj = adjacent_vertices( g, u );
+    return std::binary_search( adj.first, adj.second, vertex_id( v ) );
+}
+
+// Build a csr_graph from the map-based graph.  Since each std::map
+// is already sorted by target, this is a single copying pass.
+// Complexity: O( |V| + |E| )
+csr_graph make_csr_graph( graph const& g )
+{
+    csr_graph result;
+    result.offsets.reserve( g.size() + 1 );
+    for ( vertex_id u = 0; u < g.size(); ++u )
+        result.offsets.push_back( result.offsets.back() + g[u].size() );
+
+    result.targets.reserve( result.offsets.back() );
+    result.weights.reserve( result.offsets.back() );
+    for ( vertex_id u = 0; u < g.size(); ++u )
+    {
+        for ( weighted_neighbors_t::const_iterator p = g[u].begin(), e = g[u].end();
+              p != e; ++p )
+        {
+            result.targets.push_back( p->first );
+            result.weights.push_back( p->second );
+        }
+    }
+    return result;
+}
+
+// Build a csr_graph from an adjacency_list, giving every edge weight
+// w.  Each neighbors_t is kept sorted by add_edge, so the rows come
+// out sorted.
+// Complexity: O( |V| + |E| )
+csr_graph make_csr_graph( adjacency_list const& g, edge_weight w = 1 )
+{
+    csr_graph result;
+    result.offsets.reserve( g.size() + 1 );
+    for ( vertex_id u = 0; u < g.size(); ++u )
+    {
+        result.offsets.push_back( result.offsets.back() + g[u].size() );
+        result.targets.insert( result.targets.end(), g[u].begin(), g[u].end() );
+    }
+    result.weights.assign( result.targets.size(), w );
+    return result;
+}
+
+// Build a csr_graph from an edge_list, giving every edge weight w.
+// The vertex count is one more than the largest endpoint, as in
+// write_adjacency_matrix( edge_list const& ).  Edges are bucketed by
+// source with a counting pass, so a sorted edge_list (the invariant
+// maintained by add_edge) produces sorted rows.
+// Complexity: O( |V| + |E| )
+csr_graph make_csr_graph( edge_list const& g, edge_weight w = 1 )
+{
+    std::size_t vcnt = 0;
+    for ( edge_list::const_iterator p = g.begin(), e = g.end(); p != e; ++p )
+        vcnt = std::max( vcnt, std::size_t( std::max( p->first, p->second ) ) + 1 );
+
+    csr_graph result;
+    result.offsets.assign( vcnt + 1, 0 );
+    for ( edge_list::const_iterator p = g.begin(), e = g.end(); p != e; ++p )
+        ++result.offsets[p->first + 1];
+    for ( std::size_t u = 0; u < vcnt; ++u )
+        result.offsets[u + 1] += result.offsets[u];
+
+    // Scatter each edge into the next free slot of its source's row
+    std::vector<std::size_t> next( result.offsets.begin(), result.offsets.end() - 1 );
+    result.targets.resize( g.size() );
+    for ( edge_list::const_iterator p = g.begin(), e = g.end(); p != e; ++p )
+        result.targets[next[p->first]++] = p->second;
+
+    result.weights.assign( result.targets.size(), w );
+    return result;
+}
+
+// Find all vertices reachable in one step from both u and v, and
+// write their ids into results.  Return the past-the-end position in
+// the sequence of written result values.
+//
+// Complexity: O( count_adj(g, u) + count_adj(g, v) )
+template <class OutputIterator>
+OutputIterator
+common_neighbors(
+    csr_graph const& g, vertex_id u, vertex_id v, OutputIterator results )
+{
+    std::pair<vertex_id const*, vertex_id const*>
+        adj_u = adjacent_vertices( g, u ), adj_v = adjacent_vertices( g, v );
+    return std::set_intersection(
+        adj_u.first, adj_u.second, adj_v.first, adj_v.second, results );
+}
+
+// A simple breadth-first search starting from u for vertex v.
+// Returns true iff v is reachable from u.  Complexity: O(|V|+|E|)
+bool bfs( csr_graph const& g, vertex_id u, vertex_id v )
+{
+    std::vector<bool> visited( count_vertices( g ) );
+    std::deque<vertex_id> q;
+    q.push_back( u );
+
+    while ( !q.empty() )
+    {
+        vertex_id const next = q.front();
+        q.pop_front();
+        if ( next == v )
+            return true;
+        if ( !visited[next] )
+        {
+            visited[next] = true;
+
+            std::pair<vertex_id const*, vertex_id const*> adj = adjacent_vertices( g, next );
+            q.insert( q.end(), adj.first, adj.second );
+        }
+    }
+    return false;
+}
+
+// Compute the shortest path from s to dst, writing the ids of
+// vertices on the path (excluding s), in reverse order, into
+// out_path.  Return a pair consisting of the total path cost and the
+// resulting value of out_path.
+//
+// This is the algorithm of poor_dijkstra in poor_dijkstra_solution.cpp;
+// only the edge scan differs.
+template <class OutputIterator>
+std::pair<edge_weight,OutputIterator>
+poor_dijkstra( csr_graph const& g, vertex_id s, vertex_id dst, OutputIterator out_path )
+{
+    // This is "S" from the pseudocode
+    std::vector<bool> visited( count_vertices( g ) );
+
+    // shortest distance to each vertex starts at infinity
+    std::vector<edge_weight> d(
+        count_vertices( g ), std::numeric_limits<edge_weight>::infinity() );
+
+    // Each vertex starts as its own predecessor in shortest path from s
+    std::vector<vertex_id> p( count_vertices( g ) );
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+        p[u] = u;
+
+    // A weighted edge is an edge weight plus an edge
+    typedef std::pair<edge_weight, edge> weighted_edge;
+
+    std::priority_queue<
+      weighted_edge, std::vector<weighted_edge>, std::greater<weighted_edge>
+    > q;
+
+    q.push( std::make_pair( 0.0, std::make_pair( s, s ) ) );
+
+    while ( !q.empty() )
+    {
+        // grab the t,u,x triple from the top of the queue
+        weighted_edge const tux = q.top();
+        vertex_id const t = tux.second.first, u = tux.second.second;
+        edge_weight const x = tux.first;
+        q.pop();
+
+        if ( !visited[u] )
+        {
+            d[u] = x;
+            p[u] = t;
+            visited[u] = true;
+
+            for ( std::size_t i = g.offsets[u], last = g.offsets[u + 1]; i != last; ++i )
+            {
+                if ( !visited[g.targets[i]] )
+                {
+                    q.push(
+                        weighted_edge( x + g.weights[i], std::make_pair( u, g.targets[i] ) )
+                        );
+                }
+            }
+        }
+    }
+
+    // Get the total cost of the shortest path
+    edge_weight w = d[ dst ];
+
+    // Walk backwards from dst until we find a self-loop, writing out
+    // vertices along the way.
+    while ( p[dst] != dst )
+    {
+        *out_path++ = dst;
+        dst = p[dst];
+    }
+
+    // Return total cost plus new iterator
+    return std::make_pair( w, out_path );
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = g.size();
+        g.resize( src + 1 );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + g[src].size()) * 1.0 / g.size();
+            g[src].insert( std::make_pair( vertex_id( dst ), w ) );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, csr_graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << std::endl;
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    graph mg;
+    read_adjacency_list( std::cin, mg );
+
+    csr_graph g = make_csr_graph( mg );
+    write_adjacency_matrix( std::cout, g );
+
+    if ( argc == 3 )
+    {
+        vertex_id u, v;
+        std::stringstream(argv[1]) >> u;
+        std::stringstream(argv[2]) >> v;
+
+        std::cout << "common neighbors of vertices " << u << " and " << v << ": ";
+        common_neighbors( g, u, v, std::ostream_iterator<vertex_id>( std::cout, " " ) );
+        std::cout << std::endl;
+
+        std::cout << "vertex " << v << " is " << (bfs( g, u, v ) ? "" : "not ")
+                  << "reachable from vertex " << u << std::endl;
+
+        std::cout << "reverse shortest path: ";
+        edge_weight w;
+        w = poor_dijkstra(
+            g, u, v,
+            std::ostream_iterator<vertex_id>( std::cout, " " ) ).first;
+        std::cout << "has length: " << w << std::endl;
+    }
+}
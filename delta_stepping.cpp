@@ -0,0 +1,559 @@
+/*
+    g++ -O2 -pthread delta_stepping.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 2 0 4
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    reverse shortest path: 0 3 4 has length: 0.783333
+    distances from vertex 2: 0.783333 0.733333 0 0.533333 0.333333 0.666667
+    delta: 0.666667, 4 threads
+
+Notes:
+delta-stepping (Meyer & Sanders, "Delta-stepping: a parallelizable
+shortest path algorithm", J. Algorithms 2003)
+vertices wait in buckets of width delta by tentative distance; the
+lowest non-empty bucket is emptied with all threads at once
+light edges (weight <= delta) can put a vertex back into the current
+bucket, so they are relaxed round by round until it stays empty;
+heavy edges always land in later buckets, so each vertex relaxes them
+once, after its bucket is finished
+each vertex's distance and predecessor share one 64-bit word, so a
+relaxation is a single compare-and-swap and the two always agree
+
+ */
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <queue>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Adjacency list graph representation
+typedef unsigned vertex_id;
+typedef float edge_weight;
+typedef std::map<vertex_id, edge_weight> neighbors_t;
+typedef std::vector<neighbors_t> graph;
+
+// Add a vertex to g and return its id
+// Complexity: O( 1 )
+inline vertex_id add_vertex( graph& g )
+{
+    vertex_id v = g.size();
+    g.resize( v + 1 );
+    return v;
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( graph const& g )
+{
+    return g.size();
+}
+
+// Return the number of outgoing edges from u in g
+inline std::size_t count_adj( graph const& g, vertex_id u )
+{
+    return g[u].size();
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(|V|) )
+inline bool has_edge(graph const& g, int u, int v)
+{
+    return g[u].find(v) != g[u].end();
+}
+
+// Add an edge in g from u to v with weight w
+// Complexity: O( log(|V|) )
+// Requires: u is a vertex in g, i.e. u < count_vertices( g )
+inline void add_edge( graph& g, vertex_id u, vertex_id v, edge_weight w )
+{
+    assert( u < count_vertices( g ) );
+    g[u].insert( std::make_pair( v, w ) );
+}
+
+// A fixed set of threads that repeatedly run a job together.  run(f)
+// calls f(t) once on each thread t in [0, size()), with the calling
+// thread acting as thread 0, and returns when every call has.
+class thread_pool
+{
+ public:
+    explicit thread_pool( unsigned n )
+        : size_( std::max( 1u, n ) ), generation_(0), running_(0), stopping_(false)
+    {
+        for ( unsigned t = 1; t < size_; ++t )
+            workers_.push_back( std::thread( &thread_pool::work, this, t ) );
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            stopping_ = true;
+        }
+        start_.notify_all();
+        for ( unsigned t = 0; t < workers_.size(); ++t )
+            workers_[t].join();
+    }
+
+    thread_pool( thread_pool const& ) = delete;
+    thread_pool& operator=( thread_pool const& ) = delete;
+
+    unsigned size() const { return size_; }
+
+    void run( std::function<void( unsigned )> const& f )
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            job_ = &f;
+            running_ = size_ - 1;
+            ++generation_;
+        }
+        start_.notify_all();
+        f( 0 );
+
+        std::unique_lock<std::mutex> lock( mutex_ );
+        done_.wait( lock, [this] { return running_ == 0; } );
+    }
+
+ private:
+    void work( unsigned t )
+    {
+        for ( unsigned long seen = 0; ; )
+        {
+            std::function<void( unsigned )> const* job;
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                start_.wait( lock, [&] { return stopping_ || generation_ != seen; } );
+                if ( stopping_ )
+                    return;
+                seen = generation_;
+                job = job_;
+            }
+            (*job)( t );
+            {
+                std::lock_guard<std::mutex> lock( mutex_ );
+                if ( --running_ == 0 )
+                    done_.notify_one();
+            }
+        }
+    }
+
+    unsigned size_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_, done_;
+    std::function<void( unsigned )> const* job_;
+    unsigned long generation_;
+    unsigned running_;
+    bool stopping_;
+};
+
+// Return a bucket width for delta-stepping on g.  Meyer & Sanders
+// take delta = Theta(1/d) for random weights in [0,1] and degree d, so
+// that a vertex has O(1) light edges; this is the weight below which
+// g's vertices have, on average, light_per_vertex out-edges, estimated
+// from a sample of at most max_sample weights.  A graph whose weights
+// are all zero gets 1.
+edge_weight auto_delta( graph const& g, double light_per_vertex = 1, std::size_t max_sample = 1 << 16 )
+{
+    std::size_t edges = 0;
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+        edges += count_adj( g, u );
+    if ( edges == 0 )
+        return 1;
+
+    std::size_t const stride = (edges + max_sample - 1) / max_sample;
+    std::vector<edge_weight> sample;
+    std::size_t i = 0;
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+            if ( i++ % stride == 0 && p->second > 0 )
+                sample.push_back( p->second );
+    if ( sample.empty() )
+        return 1;
+
+    double const fraction = std::min( 1.0, light_per_vertex * count_vertices( g ) / edges );
+    std::size_t k = std::min( sample.size() - 1, std::size_t( fraction * sample.size() ) );
+    std::nth_element( sample.begin(), sample.begin() + k, sample.end() );
+    return sample[k];
+}
+
+// g's edges in compressed sparse row form, with each vertex's light
+// edges (weight <= delta) ahead of its heavy ones: u's light edges are
+// [offsets[u], heavy[u]) and its heavy edges [heavy[u], offsets[u+1])
+// in targets and weights.  No edge weighs more than max_weight.
+struct delta_graph
+{
+    edge_weight delta;
+    edge_weight max_weight;
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> heavy;
+    std::vector<vertex_id> targets;
+    std::vector<edge_weight> weights;
+};
+
+// Return g split into light and heavy edges by delta, or by
+// auto_delta( g ) if delta is 0
+// Requires: every weight in g is non-negative and finite
+delta_graph make_delta_graph( graph const& g, edge_weight delta = 0 )
+{
+    delta_graph dg;
+    dg.delta = delta > 0 ? delta : auto_delta( g );
+    dg.max_weight = 0;
+    dg.offsets.push_back( 0 );
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( int pass = 0; pass < 2; ++pass )
+        {
+            if ( pass == 1 )
+                dg.heavy.push_back( dg.targets.size() );
+            for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+            {
+                assert( p->second >= 0 && p->second <= std::numeric_limits<edge_weight>::max() );
+                dg.max_weight = std::max( dg.max_weight, p->second );
+                if ( (p->second > dg.delta) == (pass == 1) )
+                {
+                    dg.targets.push_back( p->first );
+                    dg.weights.push_back( p->second );
+                }
+            }
+        }
+        dg.offsets.push_back( dg.targets.size() );
+    }
+    return dg;
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( delta_graph const& g )
+{
+    return g.offsets.size() - 1;
+}
+
+// The distance from the source to every vertex, and the vertex before
+// each on a shortest path.  Unreached vertices are at infinity; they
+// and the source are their own predecessors, as in poor_dijkstra.
+struct shortest_path_tree
+{
+    std::vector<edge_weight> d;
+    std::vector<vertex_id> p;
+};
+
+// A vertex's tentative distance and predecessor packed into one word:
+// the distance's bits above the predecessor.  Non-negative floats
+// order the same way as their bit patterns, so comparing the upper
+// halves compares distances.
+typedef std::uint64_t packed_label;
+
+inline packed_label pack( edge_weight d, vertex_id p )
+{
+    std::uint32_t bits;
+    std::memcpy( &bits, &d, sizeof bits );
+    return std::uint64_t( bits ) << 32 | p;
+}
+
+inline edge_weight distance_of( packed_label x )
+{
+    std::uint32_t bits = std::uint32_t( x >> 32 );
+    edge_weight d;
+    std::memcpy( &d, &bits, sizeof d );
+    return d;
+}
+
+inline vertex_id predecessor_of( packed_label x )
+{
+    return vertex_id( x );
+}
+
+// Relax, on all of pool's threads, the light edges (or, if heavy is
+// true, the heavy edges) leaving each vertex in sources.  Each thread
+// t appends the vertices whose distance it lowered to improved[t].
+void relax_edges(
+    thread_pool& pool, delta_graph const& g, std::vector<vertex_id> const& sources, bool heavy,
+    std::vector<std::atomic<packed_label> >& labels,
+    std::vector<std::vector<vertex_id> >& improved, std::size_t chunk = 64 )
+{
+    if ( sources.empty() )
+        return;
+    std::atomic<std::size_t> index( 0 );
+    pool.run( [&]( unsigned t ) {
+        for ( std::size_t first; (first = index.fetch_add( chunk )) < sources.size(); )
+        {
+            std::size_t last = std::min( first + chunk, sources.size() );
+            for ( std::size_t i = first; i < last; ++i )
+            {
+                vertex_id u = sources[i];
+                edge_weight du = distance_of( labels[u].load( std::memory_order_relaxed ) );
+                std::size_t e = heavy ? g.heavy[u] : g.offsets[u];
+                std::size_t end = heavy ? g.offsets[u + 1] : g.heavy[u];
+                for ( ; e < end; ++e )
+                {
+                    vertex_id v = g.targets[e];
+                    packed_label x = pack( du + g.weights[e], u );
+                    packed_label old = labels[v].load( std::memory_order_relaxed );
+                    while ( (x >> 32) < (old >> 32) )
+                    {
+                        if ( labels[v].compare_exchange_weak( old, x, std::memory_order_relaxed ) )
+                        {
+                            improved[t].push_back( v );
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    } );
+}
+
+// Return the shortest distance from s to every vertex of g, and a
+// shortest path tree, found by delta-stepping on pool's threads.
+//
+// Complexity: O( |V| + |E| log(|E|) + L + S ) work and O( |V| + |E| )
+// space, where L is the number of times a light edge is relaxed again
+// after its source's distance falls within the same bucket, and S, the
+// number of empty buckets stepped over in O( 1 ) each, is at most
+// |E| x min( |V| + 2, max_weight / delta + 2 ) and at most the greatest
+// distance found over delta; the buckets are processed one after
+// another, but each round of relaxations is split among the threads.
+shortest_path_tree delta_stepping( thread_pool& pool, delta_graph const& g, vertex_id s )
+{
+    std::size_t const n = count_vertices( g );
+    assert( s < n );
+    edge_weight const infinity = std::numeric_limits<edge_weight>::infinity();
+    std::size_t const none = std::size_t( -1 );
+
+    std::vector<std::atomic<packed_label> > labels( n );
+    for ( vertex_id u = 0; u < n; ++u )
+        labels[u].store( pack( infinity, u ), std::memory_order_relaxed );
+    labels[s].store( pack( 0, s ), std::memory_order_relaxed );
+
+    // Bucket b holds vertices whose tentative distance fell in
+    // [b x delta, (b+1) x delta) when they were added; queued[v] is the
+    // bucket v was last added to, so a stale entry is one whose vertex
+    // has since moved to a lower bucket.  Buckets below horizon share
+    // the ring's slots cyclically, bucket b in ring[b % ring.size()];
+    // later ones wait in overflow, lowest first, and are moved into the
+    // ring each time b reaches horizon, which then advances by the
+    // ring's size.  The ring has max_weight / delta + 2 slots, enough
+    // that nothing relaxed from bucket b passes horizon, but no more
+    // than |V| + 2.  pending and deferred count the live entries in the
+    // ring and in overflow; when the ring has none, b jumps to the
+    // lowest live bucket in overflow.
+    double const span = double( g.max_weight ) / g.delta + 2;
+    std::vector<std::vector<vertex_id> > ring(
+        span < n + 2 ? std::size_t( span ) : n + 2 );
+    std::priority_queue<std::pair<std::size_t, vertex_id>,
+                        std::vector<std::pair<std::size_t, vertex_id> >,
+                        std::greater<std::pair<std::size_t, vertex_id> > > overflow;
+    std::size_t horizon = ring.size();
+    ring[0].push_back( s );
+    std::size_t pending = 1, deferred = 0;
+    std::vector<std::size_t> queued( n, none );
+    queued[s] = 0;
+
+    // The bucket of distance d; distances too far out for a bucket
+    // index all share the last one, which is still correct, as light
+    // edges are relaxed until a bucket stays empty
+    std::size_t const last_bucket = std::size_t( 1 ) << 62;
+    auto bucket_of = [&]( edge_weight d ) {
+        double x = double( d ) / g.delta;
+        return x < last_bucket ? std::size_t( x ) : last_bucket;
+    };
+
+    std::vector<std::vector<vertex_id> > improved( pool.size() );
+    std::vector<vertex_id> frontier, sources, settled;
+
+    // settled_in[v] == b iff v is already in settled for bucket b
+    std::vector<std::size_t> settled_in( n, none );
+
+    // seen[v] == stamp iff v has already been sorted in this round
+    std::vector<std::size_t> seen( n, none );
+    std::size_t stamp = 0;
+
+    // Move every vertex the last relaxations improved to its bucket,
+    // or onto the frontier if that is the current bucket b
+    auto distribute = [&]( std::size_t b ) {
+        ++stamp;
+        for ( unsigned t = 0; t < improved.size(); ++t )
+        {
+            for ( std::size_t i = 0; i < improved[t].size(); ++i )
+            {
+                vertex_id v = improved[t][i];
+                if ( seen[v] == stamp )
+                    continue;
+                seen[v] = stamp;
+
+                std::size_t target = bucket_of(
+                    distance_of( labels[v].load( std::memory_order_relaxed ) ) );
+                if ( queued[v] == target && target != b )
+                    continue;
+                if ( queued[v] != none && queued[v] > b )
+                    --(queued[v] < horizon ? pending : deferred);
+                queued[v] = target;
+                if ( target == b )
+                    frontier.push_back( v );
+                else if ( target < horizon )
+                {
+                    assert( target - b < ring.size() );
+                    ring[target % ring.size()].push_back( v );
+                    ++pending;
+                }
+                else
+                {
+                    overflow.push( std::make_pair( target, v ) );
+                    ++deferred;
+                }
+            }
+            improved[t].clear();
+        }
+    };
+
+    for ( std::size_t b = 0; pending != 0 || deferred != 0; ++b )
+    {
+        if ( pending == 0 )
+        {
+            while ( queued[overflow.top().second] != overflow.top().first )
+                overflow.pop();
+            b = horizon = overflow.top().first;
+        }
+        if ( b == horizon )
+        {
+            horizon = b + ring.size();
+            for ( ; !overflow.empty() && overflow.top().first < horizon; overflow.pop() )
+            {
+                std::size_t target = overflow.top().first;
+                vertex_id v = overflow.top().second;
+                if ( queued[v] == target )
+                {
+                    ring[target % ring.size()].push_back( v );
+                    ++pending;
+                    --deferred;
+                }
+            }
+        }
+
+        std::vector<vertex_id>& bucket = ring[b % ring.size()];
+        if ( bucket.empty() )
+            continue;
+        frontier.clear();
+        for ( std::size_t i = 0; i < bucket.size(); ++i )
+            if ( queued[bucket[i]] == b )
+                frontier.push_back( bucket[i] );
+        pending -= frontier.size();
+        bucket.clear();
+
+        // Light edges, round by round until the bucket stays empty
+        settled.clear();
+        while ( !frontier.empty() )
+        {
+            for ( std::size_t i = 0; i < frontier.size(); ++i )
+            {
+                if ( settled_in[frontier[i]] != b )
+                    settled.push_back( frontier[i] );
+                settled_in[frontier[i]] = b;
+            }
+            sources.swap( frontier );
+            frontier.clear();
+            relax_edges( pool, g, sources, false, labels, improved );
+            distribute( b );
+        }
+
+        // Heavy edges, once per vertex the bucket settled
+        relax_edges( pool, g, settled, true, labels, improved );
+        distribute( b );
+        assert( frontier.empty() );
+    }
+
+    shortest_path_tree result;
+    result.d.resize( n );
+    result.p.resize( n );
+    for ( vertex_id u = 0; u < n; ++u )
+    {
+        packed_label x = labels[u].load( std::memory_order_relaxed );
+        result.d[u] = distance_of( x );
+        result.p[u] = predecessor_of( x );
+    }
+    return result;
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = add_vertex( g );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + count_adj(g, src)) * 1.0 / count_vertices(g);
+            add_edge( g, src, dst, w );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << '\n';
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    graph g;
+
+    read_adjacency_list( std::cin, g );
+    write_adjacency_matrix( std::cout, g );
+
+    if ( argc >= 3 )
+    {
+        vertex_id u, v;
+        std::stringstream(argv[1]) >> u;
+        std::stringstream(argv[2]) >> v;
+
+        unsigned nthreads = std::thread::hardware_concurrency();
+        if ( argc == 4 )
+            std::stringstream(argv[3]) >> nthreads;
+
+        thread_pool pool( nthreads );
+        delta_graph dg = make_delta_graph( g );
+        shortest_path_tree t = delta_stepping( pool, dg, u );
+
+        std::cout << "reverse shortest path: ";
+        for ( vertex_id x = v; t.p[x] != x; x = t.p[x] )
+            std::cout << x << ' ';
+        std::cout << "has length: " << t.d[v] << std::endl;
+
+        std::cout << "distances from vertex " << u << ": ";
+        std::copy( t.d.begin(), t.d.end(), std::ostream_iterator<edge_weight>( std::cout, " " ) );
+        std::cout << std::endl;
+
+        std::cout << "delta: " << dg.delta << ", " << pool.size() << " threads" << std::endl;
+    }
+}
@@ -0,0 +1,188 @@
+/*
+    g++ -O2 density_map.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 3 text
+      *
+    @   @
+    @ @
+
+    ... | ./g 1024 pgm > graph.pgm
+
+Notes:
+a cells x cells grid is laid over the |V| x |V| adjacency matrix
+each cell counts the edges that fall in it, in one pass over the edges
+darkness grows with the logarithm of the count, so sparse structure
+stays visible next to dense blocks
+
+ */
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <functional>
+#include <cstdint>
+
+typedef unsigned vertex_id;
+
+// Edge list graph representation (see edge_list_solution.cpp)
+typedef std::pair<vertex_id, vertex_id> edge;
+typedef std::vector<edge> edge_list;
+
+// Edge counts over a cells x cells grid laid on an adjacency matrix.
+// counts[r * cells + c] is the number of edges u->v with u in the
+// r-th band of rows and v in the c-th band of columns.
+struct density_grid
+{
+    std::size_t cells;
+    std::vector<std::uint64_t> counts;
+};
+
+// Return the band, out of cells bands over vcnt vertices, holding u
+inline std::size_t band( vertex_id u, std::size_t vcnt, std::size_t cells )
+{
+    return std::uint64_t( u ) * cells / vcnt;
+}
+
+// Add the edges in [first, last) to counts, a cells x cells grid over
+// vcnt vertices
+void count_cells(
+    edge_list::const_iterator first, edge_list::const_iterator last,
+    std::size_t vcnt, std::size_t cells, std::vector<std::uint64_t>& counts )
+{
+    for ( ; first != last; ++first )
+        ++counts[band( first->first, vcnt, cells ) * cells + band( first->second, vcnt, cells )];
+}
+
+// Return the edge counts of g over a grid of at most cells x cells,
+// where g has vcnt vertices.  The grid is never finer than one cell
+// per vertex.  The edges are split among up to nthreads threads, each
+// counting into its own grid; the grids are then summed.  Each extra
+// thread costs a grid of memory and a pass to sum it, so threads are
+// only added while each has at least a grid's worth of edges to count.
+// Complexity: O( |E| + cells^2 )
+density_grid make_density_grid(
+    edge_list const& g, std::size_t vcnt, std::size_t cells, unsigned nthreads = 1 )
+{
+    density_grid result;
+    result.cells = std::max<std::size_t>( 1, std::min( cells, vcnt ) );
+    vcnt = std::max<std::size_t>( 1, vcnt );
+
+    std::size_t const n = result.cells * result.cells;
+    nthreads = std::max<std::size_t>( 1, std::min<std::size_t>( nthreads, g.size() / n ) );
+    std::vector<edge_list::const_iterator> bounds;
+    for ( unsigned t = 0; t <= nthreads; ++t )
+        bounds.push_back( g.begin() + g.size() * t / nthreads );
+
+    std::vector<std::vector<std::uint64_t> > partial( nthreads - 1, std::vector<std::uint64_t>( n ) );
+    result.counts.assign( n, 0 );
+
+    std::vector<std::thread> workers;
+    for ( unsigned t = 1; t < nthreads; ++t )
+        workers.push_back(
+            std::thread( count_cells, bounds[t], bounds[t + 1], vcnt, result.cells,
+                         std::ref( partial[t - 1] ) ) );
+    count_cells( bounds[0], bounds[1], vcnt, result.cells, result.counts );
+    for ( unsigned t = 0; t < workers.size(); ++t )
+        workers[t].join();
+
+    for ( unsigned t = 0; t < partial.size(); ++t )
+        for ( std::size_t i = 0; i < n; ++i )
+            result.counts[i] += partial[t][i];
+    return result;
+}
+
+// Return the darkness of each cell of d, from 0 (no edges) to levels - 1
+// (the densest cell), on a logarithmic scale
+std::vector<unsigned> shade( density_grid const& d, unsigned levels )
+{
+    std::uint64_t most = *std::max_element( d.counts.begin(), d.counts.end() );
+    double scale = most == 0 ? 0 : (levels - 1) / std::log1p( double( most ) );
+
+    std::vector<unsigned> result( d.counts.size() );
+    for ( std::size_t i = 0; i < d.counts.size(); ++i )
+    {
+        unsigned s = unsigned( std::ceil( std::log1p( double( d.counts[i] ) ) * scale ) );
+        result[i] = std::min( s, levels - 1 );
+    }
+    return result;
+}
+
+// Write d to output as a binary (P5) PGM image, one pixel per cell,
+// with empty cells white and the densest cell black
+void write_pgm( std::ostream& output, density_grid const& d )
+{
+    std::vector<unsigned> s = shade( d, 256 );
+    std::string pixels( s.size(), '\0' );
+    for ( std::size_t i = 0; i < s.size(); ++i )
+        pixels[i] = char( 255 - s[i] );
+
+    output << "P5\n" << d.cells << ' ' << d.cells << "\n255\n";
+    output.write( pixels.data(), pixels.size() );
+}
+
+// Write d to output as text, one character per cell, with darker
+// cells drawn with denser characters, laid out like the output of
+// write_adjacency_matrix
+void write_text( std::ostream& output, density_grid const& d )
+{
+    static char const ramp[] = " .:-=+*#%@";
+    std::vector<unsigned> s = shade( d, sizeof( ramp ) - 1 );
+
+    std::string buf;
+    for ( std::size_t r = 0; r < d.cells; ++r )
+    {
+        for ( std::size_t c = 0; c < d.cells; ++c )
+        {
+            buf += ramp[s[r * d.cells + c]];
+            buf += ' ';
+        }
+        buf += '\n';
+    }
+    output.write( buf.data(), buf.size() );
+}
+
+// Read a edge_list from input in adjacency list form, and return the
+// number of vertices: the number of lines, or one more than the
+// largest target if that is larger.
+std::size_t read_edge_list( std::istream& input, edge_list& g )
+{
+    vertex_id src = 0;
+    std::size_t vcnt = 0;
+    for ( std::string line; std::getline(input, line); ++src )
+    {
+        std::stringstream s(line);
+        for ( vertex_id dst; s >> dst; )
+        {
+            g.push_back( edge( src, dst ) );
+            vcnt = std::max( vcnt, std::size_t( dst ) + 1 );
+        }
+    }
+    return std::max<std::size_t>( vcnt, src );
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    std::size_t cells = 1024;
+    if ( argc > 1 )
+        std::stringstream(argv[1]) >> cells;
+    bool text = argc > 2 && std::string( argv[2] ) == "text";
+
+    edge_list g;
+    std::size_t vcnt = read_edge_list( std::cin, g );
+
+    density_grid d = make_density_grid( g, vcnt, cells, std::thread::hardware_concurrency() );
+    if ( text )
+        write_text( std::cout, d );
+    else
+        write_pgm( std::cout, d );
+}
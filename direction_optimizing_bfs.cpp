@@ -0,0 +1,351 @@
+/*
+    g++ -O2 direction_optimizing_bfs.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 2 0
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    vertex 0 is reachable from vertex 2 in 2 steps, path: 2 5 0
+    6 of 6 vertices reachable from vertex 2; 10 edges examined
+
+Notes:
+level-synchronous: the whole frontier is expanded before the next level
+top-down step: scan the out-edges of every frontier vertex
+bottom-up step: every unvisited vertex scans its in-edges for a parent
+on the frontier, stopping at the first one it finds
+bottom-up wins when the frontier holds most of the remaining edges
+(Beamer, Asanovic & Patterson, "Direction-Optimizing Breadth-First
+Search", SC 2012)
+
+ */
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <cstdint>
+
+// Adjacency list graph representation
+typedef unsigned vertex_id;
+typedef float edge_weight;
+typedef std::map<vertex_id, edge_weight> neighbors_t;
+typedef std::vector<neighbors_t> graph;
+
+// Add a vertex to g and return its id
+// Complexity: O( 1 )
+inline vertex_id add_vertex( graph& g )
+{
+    vertex_id v = g.size();
+    g.resize( v + 1 );
+    return v;
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( graph const& g )
+{
+    return g.size();
+}
+
+// Return the number of outgoing edges from u in g
+inline std::size_t count_adj( graph const& g, vertex_id u )
+{
+    return g[u].size();
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(|V|) )
+inline bool has_edge(graph const& g, int u, int v)
+{
+    return g[u].find(v) != g[u].end();
+}
+
+// Add an edge in g from u to v with weight w
+// Complexity: O( log(|V|) )
+// Requires: u is a vertex in g, i.e. u < count_vertices( g )
+inline void add_edge( graph& g, vertex_id u, vertex_id v, edge_weight w )
+{
+    assert( u < count_vertices( g ) );
+    g[u].insert( std::make_pair( v, w ) );
+}
+
+// Return a reverse index of g: a graph with an edge from v to u of
+// weight w for every edge from u to v of weight w in g.
+// Complexity: O( |V| + |E| )
+graph transposed_graph( graph const& g )
+{
+    graph result( count_vertices( g ) );
+    for ( vertex_id u = 0, n = count_vertices( g ); u != n; ++u )
+    {
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+        {
+            if ( p->first >= result.size() )
+                result.resize( p->first + 1 );
+            result[p->first].insert( result[p->first].end(), std::make_pair( u, p->second ) );
+        }
+    }
+    return result;
+}
+
+// A fixed-size set of vertex ids, one bit per vertex
+class vertex_bitmap
+{
+ public:
+    explicit vertex_bitmap( std::size_t n = 0 ) : words_( (n + 63) / 64 ) {}
+
+    bool test( vertex_id v ) const
+    {
+        return words_[v / 64] >> (v % 64) & 1;
+    }
+
+    void set( vertex_id v )
+    {
+        words_[v / 64] |= std::uint64_t( 1 ) << (v % 64);
+    }
+
+    void clear()
+    {
+        std::fill( words_.begin(), words_.end(), 0 );
+    }
+
+ private:
+    std::vector<std::uint64_t> words_;
+};
+
+// The depth assigned to vertices a search did not reach
+unsigned const unreached = std::numeric_limits<unsigned>::max();
+
+// The breadth-first tree found by a search.  depth[v] is the number of
+// edges on a shortest path from the root to v, or unreached.
+// parent[v] is v's predecessor on such a path; the root and unreached
+// vertices are their own parents.
+struct bfs_tree
+{
+    std::vector<unsigned> depth;
+    std::vector<vertex_id> parent;
+
+    // Statistics: the number of edges looked at, and the number of
+    // levels expanded top-down and bottom-up
+    std::size_t edges_examined;
+    unsigned top_down_steps;
+    unsigned bottom_up_steps;
+};
+
+// True iff v was reached in the search that produced t
+inline bool reachable( bfs_tree const& t, vertex_id v )
+{
+    return t.depth[v] != unreached;
+}
+
+// Tuning parameters of direction_optimizing_bfs, named as in Beamer
+// et al.  Switch to bottom-up when the frontier's out-edges exceed
+// 1/alpha of the unvisited vertices' out-edges; switch back when the
+// frontier falls below 1/beta of the vertices.
+struct direction_policy
+{
+    unsigned alpha;
+    unsigned beta;
+};
+
+direction_policy const beamer_policy = { 14, 24 };
+
+// Expand frontier top-down into next: every unvisited out-neighbor of
+// a frontier vertex joins the next level.  Return the sum of the
+// out-degrees of the new level.
+std::size_t top_down_step(
+    graph const& g, std::vector<vertex_id> const& frontier, std::vector<vertex_id>& next,
+    vertex_bitmap& visited, bfs_tree& t )
+{
+    std::size_t next_edges = 0;
+    for ( std::size_t i = 0; i < frontier.size(); ++i )
+    {
+        vertex_id u = frontier[i];
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+        {
+            ++t.edges_examined;
+            vertex_id v = p->first;
+            if ( !visited.test( v ) )
+            {
+                visited.set( v );
+                t.parent[v] = u;
+                t.depth[v] = t.depth[u] + 1;
+                next.push_back( v );
+                next_edges += count_adj( g, v );
+            }
+        }
+    }
+    return next_edges;
+}
+
+// Expand frontier bottom-up into next: every unvisited vertex with an
+// in-neighbor in in_frontier joins the next level.  Return the sum of
+// the out-degrees of the new level.
+std::size_t bottom_up_step(
+    graph const& g, graph const& rg, vertex_bitmap const& in_frontier, unsigned depth,
+    std::vector<vertex_id>& next, vertex_bitmap& visited, bfs_tree& t )
+{
+    std::size_t next_edges = 0;
+    for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+    {
+        if ( visited.test( v ) )
+            continue;
+
+        for ( neighbors_t::const_iterator p = rg[v].begin(), e = rg[v].end(); p != e; ++p )
+        {
+            ++t.edges_examined;
+            if ( in_frontier.test( p->first ) )
+            {
+                visited.set( v );
+                t.parent[v] = p->first;
+                t.depth[v] = depth + 1;
+                next.push_back( v );
+                next_edges += count_adj( g, v );
+                break;
+            }
+        }
+    }
+    return next_edges;
+}
+
+// A level-synchronous breadth-first search of g from root that
+// chooses, level by level, between top-down and bottom-up expansion.
+// rg must be transposed_graph( g ); it supplies the in-edges for
+// bottom-up steps.  Each vertex enters a frontier at most once, so
+// frontier memory is O(|V|) no matter how many edges reach a vertex.
+//
+// Complexity: O(|V|+|E|) for each kind of step, but on low-diameter
+// graphs the bottom-up steps examine far fewer than |E| edges.
+bfs_tree direction_optimizing_bfs(
+    graph const& g, graph const& rg, vertex_id root,
+    direction_policy policy = beamer_policy )
+{
+    std::size_t const n = count_vertices( g );
+    assert( count_vertices( rg ) >= n && root < n );
+
+    bfs_tree t;
+    t.depth.assign( n, unreached );
+    t.parent.resize( n );
+    for ( vertex_id u = 0; u < n; ++u )
+        t.parent[u] = u;
+    t.edges_examined = t.top_down_steps = t.bottom_up_steps = 0;
+
+    vertex_bitmap visited( n ), in_frontier( n );
+    std::vector<vertex_id> frontier( 1, root ), next;
+    visited.set( root );
+    t.depth[root] = 0;
+
+    // Out-edges of the frontier, and of the vertices not yet visited
+    std::size_t frontier_edges = count_adj( g, root ), unvisited_edges = 0;
+    for ( vertex_id u = 0; u < n; ++u )
+        unvisited_edges += count_adj( g, u );
+    unvisited_edges -= frontier_edges;
+
+    bool bottom_up = false;
+    while ( !frontier.empty() )
+    {
+        if ( !bottom_up )
+            bottom_up = frontier_edges > unvisited_edges / policy.alpha;
+        else
+            bottom_up = frontier.size() >= n / policy.beta;
+
+        next.clear();
+        std::size_t next_edges;
+        if ( bottom_up )
+        {
+            in_frontier.clear();
+            for ( std::size_t i = 0; i < frontier.size(); ++i )
+                in_frontier.set( frontier[i] );
+            next_edges = bottom_up_step(
+                g, rg, in_frontier, t.depth[frontier[0]], next, visited, t );
+            ++t.bottom_up_steps;
+        }
+        else
+        {
+            next_edges = top_down_step( g, frontier, next, visited, t );
+            ++t.top_down_steps;
+        }
+
+        frontier.swap( next );
+        frontier_edges = next_edges;
+        unvisited_edges -= next_edges;
+    }
+    return t;
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = add_vertex( g );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + count_adj(g, src)) * 1.0 / count_vertices(g);
+            add_edge( g, src, dst, w );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << '\n';
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    graph g;
+
+    read_adjacency_list( std::cin, g );
+    write_adjacency_matrix( std::cout, g );
+
+    if ( argc == 3 )
+    {
+        vertex_id u, v;
+        std::stringstream(argv[1]) >> u;
+        std::stringstream(argv[2]) >> v;
+
+        bfs_tree t = direction_optimizing_bfs( g, transposed_graph( g ), u );
+
+        std::cout << "vertex " << v << " is ";
+        if ( reachable( t, v ) )
+        {
+            std::vector<vertex_id> path( 1, v );
+            for ( vertex_id x = v; t.parent[x] != x; x = t.parent[x] )
+                path.push_back( t.parent[x] );
+            std::cout << "reachable from vertex " << u << " in " << t.depth[v]
+                      << " steps, path: ";
+            std::copy( path.rbegin(), path.rend(),
+                       std::ostream_iterator<vertex_id>( std::cout, " " ) );
+        }
+        else
+            std::cout << "not reachable from vertex " << u;
+        std::cout << std::endl;
+
+        std::size_t reached = std::count_if(
+            t.depth.begin(), t.depth.end(), []( unsigned d ) { return d != unreached; } );
+        std::cout << reached << " of " << count_vertices( g )
+                  << " vertices reachable from vertex " << u << "; "
+                  << t.edges_examined << " edges examined" << std::endl;
+    }
+}
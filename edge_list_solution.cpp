@@ -32,6 +32,8 @@ erase returns new iterator
 #include <iostream>
 #include <utility>
 #include <numeric>
+#include <thread>
+#include <functional>
 
 // Adjacency list graph representation
 typedef unsigned vertex_id;
@@ -87,6 +89,27 @@ inline void add_edge( adjacency_list& g, vertex_id u, vertex_id v )
     g[u].insert( std::lower_bound( g[u].begin(), g[u].end(), v ), v );
 }
 
+// Restore the invariants of g after edges have been appended with
+// push_back in arbitrary order: edges sorted, with duplicates
+// removed.  Appending a batch of edges and then calling sort_edges
+// once replaces one O(|E|) add_edge insert per edge.
+// Complexity: O( |E| log(|E|) )
+inline void sort_edges( edge_list& g )
+{
+    std::sort( g.begin(), g.end() );
+    g.erase( std::unique( g.begin(), g.end() ), g.end() );
+}
+
+// Complexity: O( |V| + |E| log(|V|) )
+inline void sort_edges( adjacency_list& g )
+{
+    for ( vertex_id u = 0, n = count_vertices( g ); u != n; ++u )
+    {
+        std::sort( g[u].begin(), g[u].end() );
+        g[u].erase( std::unique( g[u].begin(), g[u].end() ), g[u].end() );
+    }
+}
+
 // Background: to remove an element from a vector<T> v, invoke
 // v.erase(x) where x is a vector<T>::iterator to the element
 
@@ -108,22 +131,181 @@ inline void delete_edge( adjacency_list& g, vertex_id u, vertex_id v )
         g[u].erase( p );
 }
 
-// Write another function delete_self_loops( g ) that uses del_edge to
-// delete all self-loops from the edge_list
-inline void delete_self_loops( adjacency_list& g )
+// The number of edges a batch update actually added to and removed
+// from a graph.
+struct batch_counts
+{
+    std::size_t added;
+    std::size_t removed;
+};
+
+// Sort and deduplicate a batch of insertions and deletions, and drop
+// from the deletions anything that is also being inserted.
+// Complexity: O( b log(b) ), where b is the batch size
+template <class T>
+void normalize_batch( std::vector<T>& insertions, std::vector<T>& deletions )
+{
+    std::sort( insertions.begin(), insertions.end() );
+    insertions.erase( std::unique( insertions.begin(), insertions.end() ), insertions.end() );
+    std::sort( deletions.begin(), deletions.end() );
+    deletions.erase(
+        std::set_difference( deletions.begin(), deletions.end(),
+                             insertions.begin(), insertions.end(),
+                             deletions.begin() ),
+        deletions.end() );
+}
+
+// Merge the sorted sequence seq with a normalized batch of sorted
+// insertions and deletions in a single pass.  Every copy of a deleted
+// value is removed; an inserted value already in seq is not added
+// again.
+// Complexity: O( seq.size() + insertions.size() + deletions.size() )
+template <class T>
+batch_counts merge_batch(
+    std::vector<T>& seq, std::vector<T> const& insertions, std::vector<T> const& deletions )
+{
+    batch_counts n = { 0, 0 };
+    std::vector<T> result;
+    result.reserve( seq.size() + insertions.size() );
+
+    typename std::vector<T>::const_iterator
+        p = seq.begin(), pe = seq.end(),
+        i = insertions.begin(), ie = insertions.end(),
+        d = deletions.begin(), de = deletions.end();
+
+    while ( p != pe || i != ie )
+    {
+        if ( i == ie || (p != pe && *p < *i) )
+        {
+            while ( d != de && *d < *p )
+                ++d;
+            if ( d != de && *d == *p )
+                ++n.removed;
+            else
+                result.push_back( *p );
+            ++p;
+        }
+        else if ( p == pe || *i < *p )
+        {
+            result.push_back( *i++ );
+            ++n.added;
+        }
+        else
+        {
+            // Already present; keep the existing edge
+            result.push_back( *p++ );
+            ++i;
+        }
+    }
+    seq.swap( result );
+    return n;
+}
+
+// Apply a batch of edge insertions and deletions to g in one merge
+// pass.  An edge that is both inserted and deleted ends up in g.
+// Return how many edges were actually added and removed.
+// Complexity: O( |E| + b log(b) ), where b is the batch size
+batch_counts update_edges( edge_list& g, edge_list insertions, edge_list deletions )
+{
+    normalize_batch( insertions, deletions );
+    return merge_batch( g, insertions, deletions );
+}
+
+// Only the neighbors_t of vertices named as a source in the batch are
+// rewritten.
+// Complexity: O( |E| + b log(b) ), where b is the batch size
+// Requires: every source in the batch is a vertex in g
+batch_counts update_edges( adjacency_list& g, edge_list insertions, edge_list deletions )
 {
+    normalize_batch( insertions, deletions );
+
+    batch_counts n = { 0, 0 };
+    neighbors_t row_insertions, row_deletions;
+    edge_list::const_iterator
+        i = insertions.begin(), ie = insertions.end(),
+        d = deletions.begin(), de = deletions.end();
+
+    while ( i != ie || d != de )
+    {
+        // The next source vertex with any work in the batch
+        vertex_id u = i == ie ? d->first
+            : d == de ? i->first : std::min( i->first, d->first );
+        assert( u < count_vertices( g ) );
+
+        row_insertions.clear();
+        for ( ; i != ie && i->first == u; ++i )
+            row_insertions.push_back( i->second );
+        row_deletions.clear();
+        for ( ; d != de && d->first == u; ++d )
+            row_deletions.push_back( d->second );
+
+        batch_counts row = merge_batch( g[u], row_insertions, row_deletions );
+        n.added += row.added;
+        n.removed += row.removed;
+    }
+    return n;
+}
+
+// Keep only the edges (u,v) of g for which keep(u, v) is true,
+// compacting the survivors in place in a single pass.  Return the
+// number of edges removed.
+// Complexity: O( |E| )
+template <class Predicate>
+std::size_t filter_edges( edge_list& g, Predicate keep )
+{
+    edge_list::iterator out = g.begin();
+    for ( edge_list::iterator p = g.begin(), e = g.end(); p != e; ++p )
+        if ( keep( p->first, p->second ) )
+            *out++ = *p;
+
+    std::size_t removed = g.end() - out;
+    g.erase( out, g.end() );
+    return removed;
+}
+
+// Complexity: O( |V| + |E| )
+template <class Predicate>
+std::size_t filter_edges( adjacency_list& g, Predicate keep )
+{
+    std::size_t removed = 0;
     for ( vertex_id u = 0, n = count_vertices( g ); u != n; ++u )
-        delete_edge(g, u, u);
+    {
+        neighbors_t::iterator out = g[u].begin();
+        for ( neighbors_t::iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+            if ( keep( u, *p ) )
+                *out++ = *p;
+
+        removed += g[u].end() - out;
+        g[u].erase( out, g[u].end() );
+    }
+    return removed;
+}
+
+// A function object that is true for every edge except self-loops
+struct not_self_loop
+{
+    // Complexity: O( 1 )
+    bool operator()( vertex_id u, vertex_id v ) const
+    {
+        return u != v;
+    }
+};
+
+// Delete all self-loops from g
+// Complexity: O( |V| + |E| )
+inline void delete_self_loops( adjacency_list& g )
+{
+    filter_edges( g, not_self_loop() );
 }
 
 inline void delete_self_loops( edge_list& g )
 {
-    for ( edge_list::iterator p = g.begin(), e = g.end(); p != e; ++p )
-        if ( p->first == p->second )
-            p = g.erase(p);
+    filter_edges( g, not_self_loop() );
 }
 
-// Read a adjacency_list from input in adjacency list form.
+// Read a adjacency_list from input in adjacency list form.  Edges
+// are appended as they are parsed and put in order once at the end.
+// Complexity: O( |V| + |E| log(|V|) )
 void read_adjacency_list( adjacency_list& g )
 {
     for ( std::string line("x"); std::getline(std::cin, line); )
@@ -133,12 +315,15 @@ void read_adjacency_list( adjacency_list& g )
         std::stringstream s(line);
         for ( vertex_id dst; s >> dst; )
         {
-            add_edge( g, src, dst );
+            g[src].push_back( dst );
         }
     }
+    sort_edges( g );
 }
 
-// Read a edge_list from input in adjacency list form.
+// Read a edge_list from input in adjacency list form.  Edges are
+// appended as they are parsed and put in order once at the end.
+// Complexity: O( |E| log(|E|) )
 void read_edge_list( edge_list& g )
 {
     vertex_id src = 0;
@@ -147,54 +332,244 @@ void read_edge_list( edge_list& g )
         std::stringstream s(line);
         for ( vertex_id dst; s >> dst; )
         {
-            add_edge( g, src, dst );
+            g.push_back( edge( src, dst ) );
         }
     }
+    sort_edges( g );
 }
 
-// Write a g to output in adjacency matrix form.
+// Output is collected in a std::string and handed to std::cout in
+// blocks of about this many bytes, rather than flushed line by line.
+std::size_t const output_block_size = 1 << 16;
+
+// Write buf to std::cout and empty it if it has reached
+// output_block_size, or unconditionally if force is true
+inline void flush_output( std::string& buf, bool force = false )
+{
+    if ( force || buf.size() >= output_block_size )
+    {
+        std::cout.write( buf.data(), buf.size() );
+        buf.clear();
+    }
+}
+
+// Append the decimal digits of x to buf
+// Complexity: O( log(x) )
+inline void append_number( std::string& buf, vertex_id x )
+{
+    char digits[16];
+    char* p = digits + sizeof( digits );
+    do
+        *--p = '0' + x % 10;
+    while ( x /= 10 );
+    buf.append( p, digits + sizeof( digits ) );
+}
+
+// Return the number of vertices in g: one more than the largest
+// endpoint of any edge
+// Complexity: O( |E| )
+inline std::size_t count_vertices( edge_list const& g )
+{
+    vertex_id vcnt = 0;
+    for ( edge_list::const_iterator p = g.begin(), e = g.end(); p != e; ++p )
+        vcnt = std::max( vcnt, std::max( p->first, p->second ) + 1 );
+    return vcnt;
+}
+
+// Write a g to output in adjacency matrix form.  Each row starts as
+// a copy of an empty row and gets a '*' for each of the row's sorted
+// neighbors, so no has_edge lookups are needed.
+// Complexity: O( |V|^2 + |E| ), with the |V|^2 term spent copying
+// whole rows
 void write_adjacency_matrix( adjacency_list const& g )
 {
+    std::string empty_row;
+    for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+        empty_row += ". ";
+    empty_row += '\n';
+
+    std::string buf;
     for ( vertex_id u = 0; u < count_vertices( g ); ++u )
     {
-        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
-            std::cout << (has_edge( g, u, v ) ? "* " : ". ");
-        std::cout << std::endl;
+        std::size_t row = buf.size();
+        buf += empty_row;
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+            if ( *p < count_vertices( g ) )
+                buf[row + 2 * *p] = '*';
+        flush_output( buf );
     }
+    flush_output( buf, true );
+}
+
+// Requires: vcnt >= count_vertices( g ); g is sorted, as add_edge keeps it
+void write_adjacency_matrix( edge_list const& g, std::size_t vcnt )
+{
+    std::string empty_row;
+    for ( vertex_id v = 0; v < vcnt; ++v )
+        empty_row += ". ";
+    empty_row += '\n';
+
+    std::string buf;
+    edge_list::const_iterator p = g.begin(), e = g.end();
+    for ( vertex_id u = 0; u < vcnt; ++u )
+    {
+        std::size_t row = buf.size();
+        buf += empty_row;
+        for ( ; p != e && p->first == u; ++p )
+            buf[row + 2 * p->second] = '*';
+        flush_output( buf );
+    }
+    flush_output( buf, true );
 }
 
 void write_adjacency_matrix( edge_list const& g )
 {
-    std::size_t vcnt = 0;
-    for ( edge_list::const_iterator p = g.begin(), e = g.end(); p != e; ++p )
-        vcnt = std::max((vertex_id)vcnt, std::max(p->first,p->second)+1);
-    
+    write_adjacency_matrix( g, count_vertices( g ) );
+}
+
+// Write a g to output in adjacency list form, the form read by
+// read_adjacency_list: line u lists the targets of u's edges.
+// Complexity: O( |V| + |E| )
+void write_adjacency_list( adjacency_list const& g )
+{
+    std::string buf;
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+        {
+            if ( p != g[u].begin() )
+                buf += ' ';
+            append_number( buf, *p );
+        }
+        buf += '\n';
+        flush_output( buf );
+    }
+    flush_output( buf, true );
+}
+
+// Requires: vcnt >= count_vertices( g ); g is sorted, as add_edge keeps it
+void write_adjacency_list( edge_list const& g, std::size_t vcnt )
+{
+    std::string buf;
+    edge_list::const_iterator p = g.begin(), e = g.end();
     for ( vertex_id u = 0; u < vcnt; ++u )
     {
-        for ( vertex_id v = 0; v < vcnt; ++v )
-            std::cout << (has_edge( g, u, v ) ? "* " : ". ");
-        std::cout << std::endl;
+        for ( edge_list::const_iterator first = p; p != e && p->first == u; ++p )
+        {
+            if ( p != first )
+                buf += ' ';
+            append_number( buf, p->second );
+        }
+        buf += '\n';
+        flush_output( buf );
+    }
+    flush_output( buf, true );
+}
+
+// Write a g to output in edge list form: one "u v" line per edge.
+// Complexity: O( |V| + |E| )
+void write_edge_list( adjacency_list const& g )
+{
+    std::string buf;
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+        {
+            append_number( buf, u );
+            buf += ' ';
+            append_number( buf, *p );
+            buf += '\n';
+        }
+        flush_output( buf );
+    }
+    flush_output( buf, true );
+}
+
+// Complexity: O( |E| )
+void write_edge_list( edge_list const& g )
+{
+    std::string buf;
+    for ( edge_list::const_iterator p = g.begin(), e = g.end(); p != e; ++p )
+    {
+        append_number( buf, p->first );
+        buf += ' ';
+        append_number( buf, p->second );
+        buf += '\n';
+        flush_output( buf );
     }
+    flush_output( buf, true );
+}
+
+// Add one to counts[v] for each edge (u,v) in [first, last)
+void count_in_degrees(
+    edge_list::const_iterator first, edge_list::const_iterator last,
+    std::vector<std::size_t>& counts )
+{
+    for ( ; first != last; ++first )
+        ++counts[first->second];
 }
 
-inline bool cmp(edge e1, edge e2)
+// Store u in g[v][next[v]++] for each edge (u,v) in [first, last)
+void scatter_transposed(
+    edge_list::const_iterator first, edge_list::const_iterator last,
+    std::vector<std::size_t>& next, adjacency_list& g )
 {
-    if (e1.second < e2.second) return true;
-    else if (e1.second > e2.second) return false;
-    else return (e1.first < e2.first);
+    for ( ; first != last; ++first )
+        g[first->second][next[first->second]++] = first->first;
 }
 
-adjacency_list transposed_adjacency_list( edge_list eg )
+// Return the adjacency_list of eg with every edge reversed.  This is
+// a counting sort on edge targets: a histogram of in-degrees sizes
+// each row, then every edge is scattered into place.  Because eg is
+// sorted by source, each row comes out sorted.
+//
+// The edges are split into nthreads contiguous chunks, each with its
+// own histogram, so that the chunks can be counted and scattered
+// concurrently without synchronization.
+//
+// Complexity: O( |V| x nthreads + |E| )
+adjacency_list transposed_adjacency_list( edge_list const& eg, unsigned nthreads = 1 )
 {
-    std::sort(eg.begin(), eg.end(), cmp);
-    adjacency_list ag;
-    
-    for ( edge_list::iterator p = eg.begin(), e = eg.end(); p != e; ++p )
+    std::size_t vcnt = count_vertices( eg );
+    nthreads = std::max( 1u, std::min<unsigned>( nthreads, eg.size() ) );
+    std::vector<edge_list::const_iterator> bounds;
+    for ( unsigned t = 0; t <= nthreads; ++t )
+        bounds.push_back( eg.begin() + eg.size() * t / nthreads );
+
+    // counts[t][v] is the number of edges into v in chunk t
+    std::vector<std::vector<std::size_t> > counts(
+        nthreads, std::vector<std::size_t>( vcnt ) );
+    std::vector<std::thread> workers;
+    for ( unsigned t = 1; t < nthreads; ++t )
+        workers.push_back(
+            std::thread( count_in_degrees, bounds[t], bounds[t + 1], std::ref( counts[t] ) ) );
+    count_in_degrees( bounds[0], bounds[1], counts[0] );
+    for ( unsigned t = 0; t < workers.size(); ++t )
+        workers[t].join();
+    workers.clear();
+
+    // Turn the counts into each chunk's starting position in each row
+    adjacency_list ag( vcnt );
+    for ( vertex_id v = 0; v < vcnt; ++v )
     {
-        while ( p->second >= count_vertices(ag) || p->first >= count_vertices(ag) )
-            add_vertex(ag);
-        add_edge(ag, p->second, p->first);
+        std::size_t total = 0;
+        for ( unsigned t = 0; t < nthreads; ++t )
+        {
+            std::size_t n = counts[t][v];
+            counts[t][v] = total;
+            total += n;
+        }
+        ag[v].resize( total );
     }
+
+    for ( unsigned t = 1; t < nthreads; ++t )
+        workers.push_back(
+            std::thread( scatter_transposed, bounds[t], bounds[t + 1],
+                         std::ref( counts[t] ), std::ref( ag ) ) );
+    scatter_transposed( bounds[0], bounds[1], counts[0], ag );
+    for ( unsigned t = 0; t < workers.size(); ++t )
+        workers[t].join();
+
     return ag;
 }
 
@@ -0,0 +1,354 @@
+/*
+    g++ -O2 indexed_dijkstra.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 2 0
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    reverse shortest path: 0 3 4 has length: 0.783333
+    poor_dijkstra: 0 3 4 has length: 0.783333
+
+Notes:
+the heap holds at most one entry per vertex; finding a shorter path to
+a queued vertex lowers its key in place (decrease-key) instead of
+queueing a second copy
+a position index maps each vertex to its slot in the heap
+a 4-ary heap is half as deep as a binary one, so the sift-up after
+each decrease-key is shorter, and the children compared in a
+sift-down sit next to each other in memory
+the search stops as soon as the target is popped: its distance can no
+longer improve
+
+ */
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <queue>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+#include <map>
+
+// Adjacency list graph representation
+typedef unsigned vertex_id;
+typedef float edge_weight;
+typedef std::map<vertex_id, edge_weight> neighbors_t;
+typedef std::vector<neighbors_t> graph;
+
+// Add a vertex to g and return its id
+// Complexity: O( 1 )
+inline vertex_id add_vertex( graph& g )
+{
+    vertex_id v = g.size();
+    g.resize( v + 1 );
+    return v;
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( graph const& g )
+{
+    return g.size();
+}
+
+// Return the number of outgoing edges from u in g
+inline std::size_t count_adj( graph const& g, vertex_id u )
+{
+    return g[u].size();
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(|V|) )
+inline bool has_edge(graph const& g, int u, int v)
+{
+    return g[u].find(v) != g[u].end();
+}
+
+// Add an edge in g from u to v with weight w
+// Complexity: O( log(|V|) )
+// Requires: u is a vertex in g, i.e. u < count_vertices( g )
+inline void add_edge( graph& g, vertex_id u, vertex_id v, edge_weight w )
+{
+    assert( u < count_vertices( g ) );
+    g[u].insert( std::make_pair( v, w ) );
+}
+
+// A d-ary min-heap of vertices keyed by edge_weight, holding each
+// vertex at most once.  Vertices must be less than the n given to the
+// constructor.
+template <unsigned Arity = 4>
+class indexed_heap
+{
+ public:
+    explicit indexed_heap( std::size_t n ) : position_( n, npos ) {}
+
+    bool empty() const { return heap_.empty(); }
+
+    std::size_t size() const { return heap_.size(); }
+
+    // True iff v is in the heap
+    bool contains( vertex_id v ) const { return position_[v] != npos; }
+
+    // The vertex with the least key, and its key
+    // Requires: !empty()
+    vertex_id top() const { return heap_[0].v; }
+    edge_weight top_key() const { return heap_[0].key; }
+
+    // Insert v with key k, or lower v's key to k if v is already in
+    // the heap with a greater key.  Return true iff the heap changed.
+    // Complexity: O( log(n) / log(Arity) )
+    bool push_or_decrease( vertex_id v, edge_weight k )
+    {
+        unsigned i = position_[v];
+        if ( i == npos )
+        {
+            i = heap_.size();
+            heap_.push_back( entry( k, v ) );
+        }
+        else if ( !(k < heap_[i].key) )
+            return false;
+
+        sift_up( i, entry( k, v ) );
+        return true;
+    }
+
+    // Remove and return the vertex with the least key
+    // Requires: !empty()
+    // Complexity: O( Arity x log(n) / log(Arity) )
+    vertex_id pop()
+    {
+        vertex_id v = heap_[0].v;
+        position_[v] = npos;
+        entry last = heap_.back();
+        heap_.pop_back();
+        if ( !heap_.empty() )
+            sift_down( 0, last );
+        return v;
+    }
+
+ private:
+    static unsigned const npos = unsigned( -1 );
+
+    struct entry
+    {
+        entry() {}
+        entry( edge_weight k, vertex_id u ) : key( k ), v( u ) {}
+        edge_weight key;
+        vertex_id v;
+    };
+
+    void place( unsigned i, entry const& e )
+    {
+        heap_[i] = e;
+        position_[e.v] = i;
+    }
+
+    // Put e at slot i or above, moving greater ancestors down
+    void sift_up( unsigned i, entry const& e )
+    {
+        while ( i > 0 )
+        {
+            unsigned parent = (i - 1) / Arity;
+            if ( !(e.key < heap_[parent].key) )
+                break;
+            place( i, heap_[parent] );
+            i = parent;
+        }
+        place( i, e );
+    }
+
+    // Put e at slot i or below, moving lesser children up
+    void sift_down( unsigned i, entry const& e )
+    {
+        for ( unsigned first; (first = i * Arity + 1) < heap_.size(); )
+        {
+            unsigned last = std::min<std::size_t>( first + Arity, heap_.size() ), least = first;
+            for ( unsigned c = first + 1; c < last; ++c )
+                if ( heap_[c].key < heap_[least].key )
+                    least = c;
+            if ( !(heap_[least].key < e.key) )
+                break;
+            place( i, heap_[least] );
+            i = least;
+        }
+        place( i, e );
+    }
+
+    std::vector<entry> heap_;
+    std::vector<unsigned> position_;
+};
+
+template <unsigned Arity>
+unsigned const indexed_heap<Arity>::npos;
+
+// Compute the shortest path from s to dst, writing the ids of
+// vertices on the path (excluding s), in reverse order, into
+// out_path.  Return a pair consisting of the total path cost and the
+// resulting value of out_path.  If dst is not reachable the cost is
+// infinity and nothing is written.  Same contract as poor_dijkstra;
+// when several paths tie for shortest, either may be written.
+//
+// Unlike poor_dijkstra, the queue never holds more than one entry per
+// vertex, and the search ends as soon as dst is settled.
+//
+// Complexity: O( (|V| + |E|) log(|V|) ) in the worst case, and only
+// the vertices closer to s than dst are settled.
+template <class OutputIterator>
+std::pair<edge_weight,OutputIterator>
+dijkstra( graph const& g, vertex_id s, vertex_id dst, OutputIterator out_path )
+{
+    std::size_t const n = count_vertices( g );
+    assert( s < n && dst < n );
+
+    std::vector<edge_weight> d( n, std::numeric_limits<edge_weight>::infinity() );
+    std::vector<vertex_id> p( n );
+    for ( vertex_id u = 0; u < n; ++u )
+        p[u] = u;
+
+    indexed_heap<> q( n );
+    d[s] = 0;
+    q.push_or_decrease( s, 0 );
+
+    while ( !q.empty() )
+    {
+        vertex_id const u = q.pop();
+        if ( u == dst )
+            break;
+
+        // Settled vertices have d <= d[u], so no edge can improve them
+        for ( neighbors_t::const_iterator adj = g[u].begin(), last = g[u].end();
+              adj != last; ++adj )
+        {
+            edge_weight x = d[u] + adj->second;
+            if ( x < d[adj->first] )
+            {
+                d[adj->first] = x;
+                p[adj->first] = u;
+                q.push_or_decrease( adj->first, x );
+            }
+        }
+    }
+
+    edge_weight w = d[dst];
+    while ( p[dst] != dst )
+    {
+        *out_path++ = dst;
+        dst = p[dst];
+    }
+    return std::make_pair( w, out_path );
+}
+
+// The lazy-deletion Dijkstra from poor_dijkstra_solution.cpp, kept for
+// comparison: it queues one entry per relaxation and settles every
+// reachable vertex.
+template <class OutputIterator>
+std::pair<edge_weight,OutputIterator>
+poor_dijkstra( graph const& g, vertex_id s, vertex_id dst, OutputIterator out_path )
+{
+    std::vector<bool> visited( count_vertices( g ) );
+    std::vector<edge_weight> d(
+        count_vertices( g ), std::numeric_limits<edge_weight>::infinity() );
+    std::vector<vertex_id> p( count_vertices( g ) );
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+        p[u] = u;
+
+    typedef std::pair<vertex_id, vertex_id> edge;
+    typedef std::pair<edge_weight, edge> weighted_edge;
+    std::priority_queue<
+      weighted_edge, std::vector<weighted_edge>, std::greater<weighted_edge>
+    > q;
+
+    q.push( std::make_pair( 0.0, std::make_pair( s, s ) ) );
+    while ( !q.empty() )
+    {
+        weighted_edge const& tux = q.top();
+        vertex_id const t = tux.second.first, u = tux.second.second;
+        edge_weight const x = tux.first;
+        q.pop();
+
+        if ( !visited[u] )
+        {
+            d[u] = x;
+            p[u] = t;
+            visited[u] = true;
+            for (neighbors_t::const_iterator adj = g[u].begin(), last = g[u].end();
+                 adj != last;
+                 ++adj)
+            {
+                if ( !visited[adj->first] )
+                    q.push( weighted_edge( x + adj->second, std::make_pair( u, adj->first ) ) );
+            }
+        }
+    }
+
+    edge_weight w = d[ dst ];
+    while ( p[dst] != dst )
+    {
+        *out_path++ = dst;
+        dst = p[dst];
+    }
+    return std::make_pair( w, out_path );
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = add_vertex( g );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + count_adj(g, src)) * 1.0 / count_vertices(g);
+            add_edge( g, src, dst, w );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << '\n';
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    graph g;
+
+    read_adjacency_list( std::cin, g );
+    write_adjacency_matrix( std::cout, g );
+
+    if ( argc == 3 )
+    {
+        vertex_id u, v;
+        std::stringstream(argv[1]) >> u;
+        std::stringstream(argv[2]) >> v;
+
+        std::cout << "reverse shortest path: ";
+        edge_weight w = dijkstra(
+            g, u, v, std::ostream_iterator<vertex_id>( std::cout, " " ) ).first;
+        std::cout << "has length: " << w << std::endl;
+
+        std::cout << "poor_dijkstra: ";
+        w = poor_dijkstra(
+            g, u, v, std::ostream_iterator<vertex_id>( std::cout, " " ) ).first;
+        std::cout << "has length: " << w << std::endl;
+    }
+}
@@ -23,10 +23,10 @@ vertex 0 is reachable from vertex 2
 #include <string>
 #include <sstream>
 #include <cassert>
-#include <deque>
 #include <iterator>
 #include <algorithm>
 #include <map>
+#include <cstdio>
 
 // Adjacency list graph representation
 typedef unsigned vertex_id;
@@ -71,6 +71,66 @@ inline void add_edge( graph& g, vertex_id u, vertex_id v, edge_weight w )
     g[u].insert( std::make_pair( v, w ) );
 }
 
+// Keep only the edges (u,v) of g with weight w for which keep(u, v, w)
+// is true.  Return the number of edges removed.
+// Complexity: O( |V| + |E| )
+template <class Predicate>
+std::size_t filter_edges( graph& g, Predicate keep )
+{
+    std::size_t removed = 0;
+    for ( vertex_id u = 0, n = count_vertices( g ); u != n; ++u )
+    {
+        for ( neighbors_t::iterator p = g[u].begin(), e = g[u].end(); p != e; )
+        {
+            if ( keep( u, p->first, p->second ) )
+                ++p;
+            else
+            {
+                g[u].erase( p++ );
+                ++removed;
+            }
+        }
+    }
+    return removed;
+}
+
+// A function object that is true for every edge except self-loops
+struct not_self_loop
+{
+    // Complexity: O( 1 )
+    bool operator()( vertex_id u, vertex_id v, edge_weight ) const
+    {
+        return u != v;
+    }
+};
+
+// Delete all self-loops from g
+// Complexity: O( |V| + |E| )
+inline void delete_self_loops( graph& g )
+{
+    filter_edges( g, not_self_loop() );
+}
+
+// Return a reverse index of g: a graph with an edge from v to u of
+// weight w for every edge from u to v of weight w in g.  Sources are
+// visited in increasing order, so every insertion lands at the end
+// of its map and the hinted insert is amortized O( 1 ).
+// Complexity: O( |V| + |E| )
+graph transposed_graph( graph const& g )
+{
+    graph result( count_vertices( g ) );
+    for ( vertex_id u = 0, n = count_vertices( g ); u != n; ++u )
+    {
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+        {
+            if ( p->first >= result.size() )
+                result.resize( p->first + 1 );
+            result[p->first].insert( result[p->first].end(), std::make_pair( u, p->second ) );
+        }
+    }
+    return result;
+}
+
 // A lightweight function object that compares the "first" members of
 // any two pairs having the same type.
 struct compare1st
@@ -111,33 +171,80 @@ common_neighbors(
         );
 }
 
-// A simple breadth-first search starting from u for vertex v.
-// Returns true iff v is reachable from u.  Complexity: O(|V|+|E|)
-bool bfs(graph const& g, vertex_id u, vertex_id v)
+// Scratch space bfs can reuse from one query to the next.  A vertex
+// counts as visited only if its mark holds the current query's
+// number, or epoch, so starting a query costs O( 1 ) instead of
+// O( |V| ) and only the vertices a query reaches are written.  The
+// queue keeps the storage earlier queries grew.
+class bfs_workspace
 {
-    std::vector<bool> visited( count_vertices( g ) );
-    std::deque<vertex_id> q;
+ public:
+    bfs_workspace() : epoch_( 0 ) {}
+
+    // Begin a query on a graph of n vertices, with every vertex
+    // unvisited and the queue empty
+    void start( std::size_t n )
+    {
+        if ( marks_.size() < n )
+            marks_.resize( n );
+        if ( ++epoch_ == 0 )
+        {
+            // The epoch counter wrapped: forget every old mark
+            std::fill( marks_.begin(), marks_.end(), 0 );
+            epoch_ = 1;
+        }
+        queue.clear();
+    }
+
+    bool visited( vertex_id u ) const { return marks_[u] == epoch_; }
+
+    void visit( vertex_id u ) { marks_[u] = epoch_; }
+
+    // Vertices in the order the search reached them
+    std::vector<vertex_id> queue;
+
+ private:
+    std::vector<unsigned> marks_;
+    unsigned epoch_;
+};
+
+// A simple breadth-first search starting from u for vertex v, using
+// w for all scratch space.  Returns true iff v is reachable from u.
+// Complexity: O(|V'|+|E'|), where V' and E' are the vertices and edges
+// reached before v
+bool bfs(graph const& g, vertex_id u, vertex_id v, bfs_workspace& w)
+{
+    w.start( count_vertices( g ) );
+    std::vector<vertex_id>& q = w.queue;
     q.push_back( u );
+    w.visit( u );
 
-    while ( !q.empty() )
+    for ( std::size_t head = 0; head < q.size(); ++head )
     {
-        vertex_id const next = q.front();
-        q.pop_front();
+        vertex_id const next = q[head];
         if ( next == v )
             return true;
-        if ( !visited[next] )
+
+        for ( neighbors_t::const_iterator p = g[next].begin(), e = g[next].end(); p != e; ++p )
         {
-            visited[next] = true;
-            
-            std::transform( g[next].begin(), g[next].end(),
-                            std::back_inserter( q ),
-                            project1st()
-                );
+            if ( !w.visited( p->first ) )
+            {
+                w.visit( p->first );
+                q.push_back( p->first );
+            }
         }
     }
     return false;
 }
 
+// A simple breadth-first search starting from u for vertex v.
+// Returns true iff v is reachable from u.  Complexity: O(|V|+|E|)
+bool bfs(graph const& g, vertex_id u, vertex_id v)
+{
+    bfs_workspace w;
+    return bfs( g, u, v, w );
+}
+
 // Read a graph from input in adjacency list form.
 void read_adjacency_list( std::istream& input, graph& g )
 {
@@ -155,15 +262,100 @@ void read_adjacency_list( std::istream& input, graph& g )
     }
 }
 
-// Write a g to output in adjacency matrix form.
+// Output is collected in a std::string and handed to the stream in
+// blocks of about this many bytes, rather than flushed line by line.
+std::size_t const output_block_size = 1 << 16;
+
+// Write buf to output and empty it if it has reached
+// output_block_size, or unconditionally if force is true
+inline void flush_output( std::ostream& output, std::string& buf, bool force = false )
+{
+    if ( force || buf.size() >= output_block_size )
+    {
+        output.write( buf.data(), buf.size() );
+        buf.clear();
+    }
+}
+
+// Write a g to output in adjacency matrix form.  Each row starts as
+// a copy of an empty row and gets a '*' for each of the row's
+// neighbors, so no has_edge lookups are needed.
+// Complexity: O( |V|^2 + |E| ), with the |V|^2 term spent copying
+// whole rows
 void write_adjacency_matrix( std::ostream& output, graph const& g )
 {
+    std::string empty_row;
+    for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+        empty_row += ". ";
+    empty_row += '\n';
+
+    std::string buf;
     for ( vertex_id u = 0; u < count_vertices( g ); ++u )
     {
-        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
-            output << (has_edge( g, u, v ) ? "* " : ". ");
-        output << std::endl;
+        std::size_t row = buf.size();
+        buf += empty_row;
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+            if ( p->first < count_vertices( g ) )
+                buf[row + 2 * p->first] = '*';
+        flush_output( output, buf );
+    }
+    flush_output( output, buf, true );
+}
+
+// Append the decimal digits of x to buf
+// Complexity: O( log(x) )
+inline void append_number( std::string& buf, vertex_id x )
+{
+    char digits[16];
+    char* p = digits + sizeof( digits );
+    do
+        *--p = '0' + x % 10;
+    while ( x /= 10 );
+    buf.append( p, digits + sizeof( digits ) );
+}
+
+// Write a g to output in adjacency list form, the form read by
+// read_adjacency_list: line u lists the targets of u's edges.
+// Weights are not written.
+// Complexity: O( |V| + |E| )
+void write_adjacency_list( std::ostream& output, graph const& g )
+{
+    std::string buf;
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+        {
+            if ( p != g[u].begin() )
+                buf += ' ';
+            append_number( buf, p->first );
+        }
+        buf += '\n';
+        flush_output( output, buf );
+    }
+    flush_output( output, buf, true );
+}
+
+// Write a g to output in edge list form: one "u v w" line per edge
+// from u to v with weight w.
+// Complexity: O( |V| + |E| )
+void write_edge_list( std::ostream& output, graph const& g )
+{
+    std::string buf;
+    char weight[32];
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+        {
+            append_number( buf, u );
+            buf += ' ';
+            append_number( buf, p->first );
+            buf += ' ';
+            buf.append( weight, std::snprintf( weight, sizeof( weight ), "%g", p->second ) );
+            buf += '\n';
+        }
+        flush_output( output, buf );
     }
+    flush_output( output, buf, true );
 }
 
 #include <iostream>
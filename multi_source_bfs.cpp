@@ -0,0 +1,260 @@
+/*
+    g++ -O2 multi_source_bfs.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 2 0 1 0 0 4 3 5
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    vertex 0 is reachable from vertex 2
+    vertex 0 is not reachable from vertex 1
+    vertex 4 is reachable from vertex 0
+    vertex 5 is reachable from vertex 3
+
+Notes:
+multi-source BFS (Then et al., "The More the Merrier: Efficient
+Multi-Source Graph Traversal", VLDB 2014)
+bit i of a vertex's mask stands for the i-th source of a batch
+one pass over a vertex's edges advances every search whose frontier
+holds that vertex
+std::bitset<256> words give 256 searches per pass; the compiler turns
+their operations into vector instructions where it can
+
+ */
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <algorithm>
+#include <bitset>
+#include <map>
+
+// Adjacency list graph representation
+typedef unsigned vertex_id;
+typedef float edge_weight;
+typedef std::map<vertex_id, edge_weight> neighbors_t;
+typedef std::vector<neighbors_t> graph;
+
+// Add a vertex to g and return its id
+// Complexity: O( 1 )
+inline vertex_id add_vertex( graph& g )
+{
+    vertex_id v = g.size();
+    g.resize( v + 1 );
+    return v;
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( graph const& g )
+{
+    return g.size();
+}
+
+// Return the number of outgoing edges from u in g
+inline std::size_t count_adj( graph const& g, vertex_id u )
+{
+    return g[u].size();
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(|V|) )
+inline bool has_edge(graph const& g, int u, int v)
+{
+    return g[u].find(v) != g[u].end();
+}
+
+// Add an edge in g from u to v with weight w
+// Complexity: O( log(|V|) )
+// Requires: u is a vertex in g, i.e. u < count_vertices( g )
+inline void add_edge( graph& g, vertex_id u, vertex_id v, edge_weight w )
+{
+    assert( u < count_vertices( g ) );
+    g[u].insert( std::make_pair( v, w ) );
+}
+
+// A reachability query: is second reachable from first?
+typedef std::pair<vertex_id, vertex_id> vertex_pair;
+
+// Run breadth-first searches of g from up to Lanes sources at once.
+// Return, for each vertex v, the mask of searches that reached v: bit
+// i is set iff v is reachable from sources[i].
+//
+// Only the vertices on the current frontier are expanded, and only
+// the vertices they reach are merged and reset, so a level costs time
+// for the edges it crosses rather than for the whole graph.
+//
+// Complexity: O( |V| + sum over levels of the edges leaving that
+// level's frontier ) word operations for the whole batch, which is at
+// most O( |V| + |E| x diameter ), against O( |V| + |E| ) per source
+// for separate searches
+template <std::size_t Lanes>
+std::vector<std::bitset<Lanes> >
+multi_source_bfs( graph const& g, std::vector<vertex_id> const& sources )
+{
+    typedef std::bitset<Lanes> mask;
+    assert( sources.size() <= Lanes );
+
+    std::size_t const n = count_vertices( g );
+    std::vector<mask> seen( n ), visit( n ), visit_next( n );
+    std::vector<vertex_id> frontier, next;
+    for ( std::size_t i = 0; i < sources.size(); ++i )
+    {
+        if ( visit[sources[i]].none() )
+            frontier.push_back( sources[i] );
+        seen[sources[i]].set( i );
+        visit[sources[i]].set( i );
+    }
+
+    while ( !frontier.empty() )
+    {
+        // Every search on u's frontier moves to u's neighbors
+        for ( std::size_t i = 0; i < frontier.size(); ++i )
+        {
+            vertex_id u = frontier[i];
+            for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+            {
+                if ( visit_next[p->first].none() )
+                    next.push_back( p->first );
+                visit_next[p->first] |= visit[u];
+            }
+            visit[u].reset();
+        }
+
+        // Keep only the searches reaching each vertex for the first time
+        frontier.clear();
+        for ( std::size_t i = 0; i < next.size(); ++i )
+        {
+            vertex_id v = next[i];
+            visit[v] = visit_next[v] & ~seen[v];
+            seen[v] |= visit[v];
+            visit_next[v].reset();
+            if ( visit[v].any() )
+                frontier.push_back( v );
+        }
+        next.clear();
+    }
+    return seen;
+}
+
+// Answer every query in queries, running the searches Lanes sources
+// at a time.  Element i of the result is true iff queries[i].second
+// is reachable from queries[i].first.
+// Complexity: O( Q log(Q) + S / Lanes x search ), where S is the
+// number of distinct sources among the Q queries and search is the
+// cost of one multi_source_bfs
+template <std::size_t Lanes>
+std::vector<bool> answer_reachability( graph const& g, std::vector<vertex_pair> const& queries )
+{
+    // The query indices grouped by source, in order of source
+    std::vector<std::pair<vertex_id, std::size_t> > by_source( queries.size() );
+    for ( std::size_t i = 0; i < queries.size(); ++i )
+        by_source[i] = std::make_pair( queries[i].first, i );
+    std::sort( by_source.begin(), by_source.end() );
+
+    std::vector<bool> result( queries.size() );
+    for ( std::size_t first = 0; first < by_source.size(); )
+    {
+        // The next Lanes distinct sources, and the queries from them
+        std::vector<vertex_id> batch;
+        std::size_t last = first;
+        for ( ; last < by_source.size(); ++last )
+        {
+            vertex_id s = by_source[last].first;
+            if ( batch.empty() || batch.back() != s )
+            {
+                if ( batch.size() == Lanes )
+                    break;
+                batch.push_back( s );
+            }
+        }
+        std::vector<std::bitset<Lanes> > seen = multi_source_bfs<Lanes>( g, batch );
+
+        for ( std::size_t lane = 0; first < last; ++first )
+        {
+            if ( by_source[first].first != batch[lane] )
+                ++lane;
+            std::size_t i = by_source[first].second;
+            result[i] = seen[queries[i].second].test( lane );
+        }
+    }
+    return result;
+}
+
+// Return the reachability matrix of sources: element [i][v] is true
+// iff v is reachable from sources[i].
+template <std::size_t Lanes>
+std::vector<std::vector<bool> >
+reachability_matrix( graph const& g, std::vector<vertex_id> const& sources )
+{
+    std::vector<std::vector<bool> > result( sources.size(), std::vector<bool>( count_vertices( g ) ) );
+    for ( std::size_t first = 0; first < sources.size(); first += Lanes )
+    {
+        std::size_t last = std::min( first + Lanes, sources.size() );
+        std::vector<std::bitset<Lanes> > seen = multi_source_bfs<Lanes>(
+            g, std::vector<vertex_id>( sources.begin() + first, sources.begin() + last ) );
+
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            for ( std::size_t i = first; i < last; ++i )
+                result[i][v] = seen[v].test( i - first );
+    }
+    return result;
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = add_vertex( g );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + count_adj(g, src)) * 1.0 / count_vertices(g);
+            add_edge( g, src, dst, w );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << '\n';
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    graph g;
+
+    read_adjacency_list( std::cin, g );
+    write_adjacency_matrix( std::cout, g );
+
+    std::vector<vertex_pair> queries;
+    for ( int i = 1; i + 1 < argc; i += 2 )
+    {
+        vertex_pair q;
+        std::stringstream(argv[i]) >> q.first;
+        std::stringstream(argv[i + 1]) >> q.second;
+        queries.push_back( q );
+    }
+
+    std::vector<bool> reachable = answer_reachability<256>( g, queries );
+    for ( std::size_t i = 0; i < queries.size(); ++i )
+        std::cout << "vertex " << queries[i].second << " is " << (reachable[i] ? "" : "not ")
+                  << "reachable from vertex " << queries[i].first << std::endl;
+}
@@ -0,0 +1,348 @@
+/*
+    g++ -O2 -pthread parallel_bfs.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 2 0 4
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    vertex 0 is reachable from vertex 2 (4 threads)
+
+Notes:
+one frontier level at a time; threads take chunks of the frontier
+a vertex is claimed by whichever thread first sets its bit in the
+atomic visited bitmap, so it joins the next frontier exactly once
+each thread collects its discoveries in its own buffer; the buffers
+are concatenated into the next frontier between levels
+every thread stops as soon as any of them claims the target
+
+ */
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <algorithm>
+#include <map>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Adjacency list graph representation
+typedef unsigned vertex_id;
+typedef float edge_weight;
+typedef std::map<vertex_id, edge_weight> neighbors_t;
+typedef std::vector<neighbors_t> graph;
+
+// Add a vertex to g and return its id
+// Complexity: O( 1 )
+inline vertex_id add_vertex( graph& g )
+{
+    vertex_id v = g.size();
+    g.resize( v + 1 );
+    return v;
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( graph const& g )
+{
+    return g.size();
+}
+
+// Return the number of outgoing edges from u in g
+inline std::size_t count_adj( graph const& g, vertex_id u )
+{
+    return g[u].size();
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(|V|) )
+inline bool has_edge(graph const& g, int u, int v)
+{
+    return g[u].find(v) != g[u].end();
+}
+
+// Add an edge in g from u to v with weight w
+// Complexity: O( log(|V|) )
+// Requires: u is a vertex in g, i.e. u < count_vertices( g )
+inline void add_edge( graph& g, vertex_id u, vertex_id v, edge_weight w )
+{
+    assert( u < count_vertices( g ) );
+    g[u].insert( std::make_pair( v, w ) );
+}
+
+// A fixed set of threads that repeatedly run a job together.  run(f)
+// calls f(t) once on each thread t in [0, size()), with the calling
+// thread acting as thread 0, and returns when every call has.
+class thread_pool
+{
+ public:
+    explicit thread_pool( unsigned n )
+        : size_( std::max( 1u, n ) ), generation_(0), running_(0), stopping_(false)
+    {
+        for ( unsigned t = 1; t < size_; ++t )
+            workers_.push_back( std::thread( &thread_pool::work, this, t ) );
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            stopping_ = true;
+        }
+        start_.notify_all();
+        for ( unsigned t = 0; t < workers_.size(); ++t )
+            workers_[t].join();
+    }
+
+    thread_pool( thread_pool const& ) = delete;
+    thread_pool& operator=( thread_pool const& ) = delete;
+
+    unsigned size() const { return size_; }
+
+    void run( std::function<void( unsigned )> const& f )
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            job_ = &f;
+            running_ = size_ - 1;
+            ++generation_;
+        }
+        start_.notify_all();
+        f( 0 );
+
+        std::unique_lock<std::mutex> lock( mutex_ );
+        done_.wait( lock, [this] { return running_ == 0; } );
+    }
+
+ private:
+    void work( unsigned t )
+    {
+        for ( unsigned long seen = 0; ; )
+        {
+            std::function<void( unsigned )> const* job;
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                start_.wait( lock, [&] { return stopping_ || generation_ != seen; } );
+                if ( stopping_ )
+                    return;
+                seen = generation_;
+                job = job_;
+            }
+            (*job)( t );
+            {
+                std::lock_guard<std::mutex> lock( mutex_ );
+                if ( --running_ == 0 )
+                    done_.notify_one();
+            }
+        }
+    }
+
+    unsigned size_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_, done_;
+    std::function<void( unsigned )> const* job_;
+    unsigned long generation_;
+    unsigned running_;
+    bool stopping_;
+};
+
+// A reusable rendezvous for n threads.  The last thread to arrive at
+// wait() runs the completion function before any thread leaves.
+class phase_barrier
+{
+ public:
+    phase_barrier( unsigned n, std::function<void()> completion )
+        : n_(n), waiting_(0), phase_(0), completion_(completion) {}
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock( mutex_ );
+        unsigned long phase = phase_;
+        if ( ++waiting_ == n_ )
+        {
+            completion_();
+            waiting_ = 0;
+            ++phase_;
+            lock.unlock();
+            released_.notify_all();
+        }
+        else
+            released_.wait( lock, [&] { return phase_ != phase; } );
+    }
+
+ private:
+    unsigned n_, waiting_;
+    unsigned long phase_;
+    std::function<void()> completion_;
+    std::mutex mutex_;
+    std::condition_variable released_;
+};
+
+// A fixed-size set of vertex ids, one bit per vertex, that any number
+// of threads may add to concurrently
+class atomic_vertex_bitmap
+{
+ public:
+    explicit atomic_vertex_bitmap( std::size_t n ) : words_( (n + 63) / 64 )
+    {
+        for ( std::size_t i = 0; i < words_.size(); ++i )
+            words_[i].store( 0, std::memory_order_relaxed );
+    }
+
+    // Add v; return true iff this call is the one that added it
+    bool claim( vertex_id v )
+    {
+        std::uint64_t bit = std::uint64_t( 1 ) << (v % 64);
+        std::atomic<std::uint64_t>& w = words_[v / 64];
+        if ( w.load( std::memory_order_relaxed ) & bit )
+            return false;
+        return !(w.fetch_or( bit, std::memory_order_relaxed ) & bit);
+    }
+
+ private:
+    std::vector<std::atomic<std::uint64_t> > words_;
+};
+
+// A breadth-first search starting from u for vertex v, with each
+// frontier level expanded by all of pool's threads.  Returns true iff
+// v is reachable from u.
+//
+// Threads take the frontier in chunks of frontier_chunk vertices from
+// a shared atomic index, so threads that draw high-degree vertices do
+// not hold up the level.
+//
+// Complexity: O( (|V|+|E|) / pool.size() + diameter ) when the
+// frontiers are large
+bool parallel_bfs(
+    thread_pool& pool, graph const& g, vertex_id u, vertex_id v,
+    std::size_t frontier_chunk = 64 )
+{
+    if ( u == v )
+        return true;
+
+    unsigned const nthreads = pool.size();
+    atomic_vertex_bitmap visited( count_vertices( g ) );
+    visited.claim( u );
+
+    std::vector<vertex_id> frontier( 1, u ), next;
+    std::vector<std::vector<vertex_id> > discovered( nthreads );
+    std::vector<std::size_t> offsets( nthreads + 1 );
+    std::atomic<std::size_t> index( 0 );
+    std::atomic<bool> found( false );
+    bool done = false;
+
+    // Between expanding and copying: size next and give each thread's
+    // buffer its place in it
+    phase_barrier expanded( nthreads, [&] {
+        offsets[0] = 0;
+        for ( unsigned t = 0; t < nthreads; ++t )
+            offsets[t + 1] = offsets[t] + discovered[t].size();
+        next.resize( offsets[nthreads] );
+    } );
+
+    // Between copying and the next level: advance, or stop
+    phase_barrier copied( nthreads, [&] {
+        frontier.swap( next );
+        index.store( 0, std::memory_order_relaxed );
+        done = found.load() || frontier.empty();
+    } );
+
+    pool.run( [&]( unsigned t ) {
+        std::vector<vertex_id>& mine = discovered[t];
+        while ( !done )
+        {
+            mine.clear();
+            for ( std::size_t first;
+                  !found.load( std::memory_order_relaxed )
+                      && (first = index.fetch_add( frontier_chunk )) < frontier.size(); )
+            {
+                std::size_t last = std::min( first + frontier_chunk, frontier.size() );
+                for ( std::size_t i = first; i < last; ++i )
+                {
+                    vertex_id x = frontier[i];
+                    for ( neighbors_t::const_iterator p = g[x].begin(), e = g[x].end();
+                          p != e; ++p )
+                    {
+                        if ( visited.claim( p->first ) )
+                        {
+                            if ( p->first == v )
+                                found.store( true, std::memory_order_relaxed );
+                            mine.push_back( p->first );
+                        }
+                    }
+                }
+            }
+            expanded.wait();
+
+            std::copy( mine.begin(), mine.end(), next.begin() + offsets[t] );
+            copied.wait();
+        }
+    } );
+
+    return found.load();
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = add_vertex( g );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + count_adj(g, src)) * 1.0 / count_vertices(g);
+            add_edge( g, src, dst, w );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << '\n';
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    graph g;
+
+    read_adjacency_list( std::cin, g );
+    write_adjacency_matrix( std::cout, g );
+
+    if ( argc >= 3 )
+    {
+        vertex_id u, v;
+        std::stringstream(argv[1]) >> u;
+        std::stringstream(argv[2]) >> v;
+
+        unsigned nthreads = std::thread::hardware_concurrency();
+        if ( argc == 4 )
+            std::stringstream(argv[3]) >> nthreads;
+
+        thread_pool pool( nthreads );
+        std::cout << "vertex " << v << " is " << (parallel_bfs( pool, g, u, v ) ? "" : "not ")
+                  << "reachable from vertex " << u
+                  << " (" << pool.size() << " threads)" << std::endl;
+    }
+}
@@ -0,0 +1,338 @@
+/*
+    g++ -O2 parallel_parser.cpp -o g
+    printf "2\n1\n4 5 1\n0 3\n3 1 4\n3 0\n" > graph.txt
+    ./g graph.txt 4
+    . . * . . .
+    . * . . . .
+    . * . . * *
+    * . . * . .
+    . * . * * .
+    * . . * . .
+    6 vertices, 12 edges
+    ------- edge list --------
+    0 2
+    1 1
+    2 1
+    2 4
+    2 5
+    3 0
+    3 3
+    4 1
+    4 3
+    4 4
+    5 0
+    5 3
+
+Notes:
+the file is mapped, not copied; standard input is read in one block
+chunks are split at newline boundaries and parsed concurrently
+std::from_chars does no locale lookup and no allocation
+line n of the input still describes the edges out of vertex n
+
+ */
+#include <istream>
+#include <ostream>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <cassert>
+#include <cstring>
+#include <charconv>
+#include <stdexcept>
+#include <algorithm>
+#include <thread>
+#include <functional>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+typedef unsigned vertex_id;
+
+// Adjacency list graph representation (see edge_list_solution.cpp)
+typedef std::vector<vertex_id> neighbors_t;
+typedef std::vector<neighbors_t> adjacency_list;
+
+// Edge list graph representation (see edge_list_solution.cpp)
+typedef std::pair<vertex_id, vertex_id> edge;
+typedef std::vector<edge> edge_list;
+
+// A read-only view of a whole file, memory-mapped
+class mapped_file
+{
+ public:
+    explicit mapped_file( std::string const& path )
+        : data_(0), size_(0)
+    {
+        int fd = ::open( path.c_str(), O_RDONLY );
+        if ( fd < 0 )
+            throw std::runtime_error( "cannot open " + path );
+
+        struct stat st;
+        if ( ::fstat( fd, &st ) != 0 )
+        {
+            ::close( fd );
+            throw std::runtime_error( "cannot stat " + path );
+        }
+        size_ = st.st_size;
+        if ( size_ != 0 )
+        {
+            void* p = ::mmap( 0, size_, PROT_READ, MAP_PRIVATE, fd, 0 );
+            if ( p == MAP_FAILED )
+            {
+                ::close( fd );
+                throw std::runtime_error( "cannot map " + path );
+            }
+            ::madvise( p, size_, MADV_SEQUENTIAL );
+            data_ = static_cast<char const*>( p );
+        }
+        ::close( fd );
+    }
+
+    ~mapped_file()
+    {
+        if ( size_ != 0 )
+            ::munmap( const_cast<char*>( data_ ), size_ );
+    }
+
+    mapped_file( mapped_file const& ) = delete;
+    mapped_file& operator=( mapped_file const& ) = delete;
+
+    char const* begin() const { return data_; }
+    char const* end() const { return data_ + size_; }
+
+ private:
+    char const* data_;
+    std::size_t size_;
+};
+
+// The lines parsed from one chunk of input.  The targets on the i-th
+// line are targets[i ? row_ends[i-1] : 0] .. targets[row_ends[i]-1],
+// sorted, without duplicates.
+struct parsed_chunk
+{
+    std::vector<std::size_t> row_ends;
+    std::vector<vertex_id> targets;
+};
+
+// Return the positions at which to split [first, last) into n
+// chunks of roughly equal size, each ending just after a newline
+// (or at last).  The result has n + 1 elements; some chunks may be
+// empty.
+std::vector<char const*> split_lines( char const* first, char const* last, unsigned n )
+{
+    std::vector<char const*> bounds( 1, first );
+    for ( unsigned t = 1; t < n; ++t )
+    {
+        char const* p = std::max( bounds.back(), first + (last - first) * t / n );
+        if ( p != first && p[-1] != '\n' )
+        {
+            p = static_cast<char const*>( std::memchr( p, '\n', last - p ) );
+            p = p ? p + 1 : last;
+        }
+        bounds.push_back( p );
+    }
+    bounds.push_back( last );
+    return bounds;
+}
+
+// Parse the lines in [first, last) into out.  As with the
+// std::stringstream extraction in read_adjacency_list, a line's
+// parse stops at the first token that is not an unsigned number.
+// A final line with no newline still counts.
+// Complexity: O( last - first + |E| log(|V|) )
+void parse_chunk( char const* first, char const* last, parsed_chunk& out )
+{
+    char const* p = first;
+    while ( p != last )
+    {
+        std::size_t row_begin = out.targets.size();
+        for (;;)
+        {
+            while ( p != last && (*p == ' ' || *p == '\t' || *p == '\r') )
+                ++p;
+            if ( p == last || *p == '\n' )
+                break;
+
+            vertex_id dst;
+            std::from_chars_result r = std::from_chars( p, last, dst );
+            if ( r.ec != std::errc() )
+            {
+                p = static_cast<char const*>( std::memchr( p, '\n', last - p ) );
+                if ( !p )
+                    p = last;
+                break;
+            }
+            out.targets.push_back( dst );
+            p = r.ptr;
+        }
+        if ( p != last )
+            ++p;   // the newline
+
+        std::vector<vertex_id>::iterator
+            row = out.targets.begin() + row_begin, end = out.targets.end();
+        std::sort( row, end );
+        out.targets.erase( std::unique( row, end ), end );
+        out.row_ends.push_back( out.targets.size() );
+    }
+}
+
+// Copy the rows of chunk into g, starting at vertex base
+void copy_rows( parsed_chunk const& chunk, vertex_id base, adjacency_list& g )
+{
+    std::size_t row_begin = 0;
+    for ( std::size_t i = 0; i < chunk.row_ends.size(); ++i )
+    {
+        g[base + i].assign(
+            chunk.targets.begin() + row_begin, chunk.targets.begin() + chunk.row_ends[i] );
+        row_begin = chunk.row_ends[i];
+    }
+}
+
+// Write the edges of chunk into g, starting at vertex base and at
+// position edge_base of g
+void copy_edges(
+    parsed_chunk const& chunk, vertex_id base, std::size_t edge_base, edge_list& g )
+{
+    std::size_t j = 0;
+    for ( std::size_t i = 0; i < chunk.row_ends.size(); ++i )
+        for ( ; j < chunk.row_ends[i]; ++j )
+            g[edge_base + j] = edge( base + i, chunk.targets[j] );
+}
+
+// Run f( t ) for each t in [0, n), on n threads
+template <class Function>
+void run_parallel( unsigned n, Function f )
+{
+    std::vector<std::thread> workers;
+    for ( unsigned t = 1; t < n; ++t )
+        workers.push_back( std::thread( f, t ) );
+    f( 0 );
+    for ( unsigned t = 0; t < workers.size(); ++t )
+        workers[t].join();
+}
+
+// Parse [first, last) in adjacency list form into one parsed_chunk
+// per thread, and set bases[t] to the vertex id of chunk t's first
+// line.  bases has one more element than chunks: the vertex count.
+// Complexity: O( (last - first) / nthreads + |E| log(|V|) / nthreads )
+//             if the lines are of similar length
+std::vector<parsed_chunk> parse_chunks(
+    char const* first, char const* last, unsigned nthreads, std::vector<vertex_id>& bases )
+{
+    nthreads = std::max( 1u, nthreads );
+    std::vector<char const*> bounds = split_lines( first, last, nthreads );
+    std::vector<parsed_chunk> chunks( nthreads );
+
+    run_parallel( nthreads, [&]( unsigned t ) {
+        parse_chunk( bounds[t], bounds[t + 1], chunks[t] );
+    } );
+
+    bases.assign( 1, 0 );
+    for ( unsigned t = 0; t < nthreads; ++t )
+        bases.push_back( bases.back() + chunks[t].row_ends.size() );
+    return chunks;
+}
+
+// Parse [first, last) in adjacency list form into g, using nthreads
+// threads.  Line n holds the targets of the edges out of vertex n.
+void parse_adjacency_list(
+    char const* first, char const* last, adjacency_list& g, unsigned nthreads )
+{
+    std::vector<vertex_id> bases;
+    std::vector<parsed_chunk> chunks = parse_chunks( first, last, nthreads, bases );
+
+    g.clear();
+    g.resize( bases.back() );
+    run_parallel( chunks.size(), [&]( unsigned t ) {
+        copy_rows( chunks[t], bases[t], g );
+    } );
+}
+
+// The result is sorted, as add_edge keeps an edge_list.
+void parse_edge_list(
+    char const* first, char const* last, edge_list& g, unsigned nthreads )
+{
+    std::vector<vertex_id> bases;
+    std::vector<parsed_chunk> chunks = parse_chunks( first, last, nthreads, bases );
+
+    std::vector<std::size_t> edge_bases( 1, 0 );
+    for ( std::size_t t = 0; t < chunks.size(); ++t )
+        edge_bases.push_back( edge_bases.back() + chunks[t].targets.size() );
+
+    g.clear();
+    g.resize( edge_bases.back() );
+    run_parallel( chunks.size(), [&]( unsigned t ) {
+        copy_edges( chunks[t], bases[t], edge_bases[t], g );
+    } );
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( adjacency_list const& g )
+{
+    return g.size();
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(|V|) )
+inline bool has_edge( adjacency_list const& g, int u, int v )
+{
+    return std::binary_search( g[u].begin(), g[u].end(), vertex_id( v ) );
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, adjacency_list const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << '\n';
+    }
+}
+
+#include <iostream>
+#include <sstream>
+int main( int argc, char *argv[] )
+{
+    if ( argc < 2 || argc > 3 )
+    {
+        std::cerr << "usage: " << argv[0] << " FILE|- [threads]" << std::endl;
+        return 1;
+    }
+
+    unsigned nthreads = std::thread::hardware_concurrency();
+    if ( argc == 3 )
+        std::stringstream(argv[2]) >> nthreads;
+
+    try
+    {
+        adjacency_list g;
+        edge_list eg;
+        if ( std::string( argv[1] ) == "-" )
+        {
+            std::string text( (std::istreambuf_iterator<char>( std::cin )),
+                              std::istreambuf_iterator<char>() );
+            parse_adjacency_list( text.data(), text.data() + text.size(), g, nthreads );
+            parse_edge_list( text.data(), text.data() + text.size(), eg, nthreads );
+        }
+        else
+        {
+            mapped_file text( argv[1] );
+            parse_adjacency_list( text.begin(), text.end(), g, nthreads );
+            parse_edge_list( text.begin(), text.end(), eg, nthreads );
+        }
+
+        write_adjacency_matrix( std::cout, g );
+        std::cout << count_vertices( g ) << " vertices, " << eg.size() << " edges" << std::endl;
+        std::cout << "------- edge list --------" << std::endl;
+        for ( edge_list::const_iterator p = eg.begin(), e = eg.end(); p != e; ++p )
+            std::cout << p->first << ' ' << p->second << '\n';
+    }
+    catch ( std::exception const& e )
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -14,6 +14,7 @@
     * . . * . . 
     common neighbors of vertices 2 and 0: 
     reverse shortest path: 0 3 4 has length: 0.783333
+    with unsigned weights: 0 3 4 has length: 3
 
  */
 
@@ -21,29 +22,34 @@
 #include <string>
 #include <sstream>
 #include <cassert>
-#include <queue>
 #include <iterator>
 #include <algorithm>
 #include <map>
+#include <limits>
 #include <istream>
 #include <ostream>
 
-// Adjacency list graph representation
+// Adjacency list graph representation, with edges weighted by values
+// of type Weight.  graph, weighted by edge_weight, is the usual one.
 typedef unsigned vertex_id;
 typedef float edge_weight;
-typedef std::map<vertex_id, edge_weight> neighbors_t;
-typedef std::vector<neighbors_t> graph;
+template <class Weight>
+using basic_graph = std::vector<std::map<vertex_id, Weight> >;
+typedef basic_graph<edge_weight> graph;
+typedef graph::value_type neighbors_t;
 
 // True iff there is an edge in g from u to v
 // Complexity: O( log(|V|) )
-inline bool has_edge(graph const& g, int u, int v)
+template <class Weight>
+inline bool has_edge(basic_graph<Weight> const& g, int u, int v)
 {
     return g[u].find(v) != g[u].end();
 }
 
 // Add a vertex to g and return its id
 // Complexity: O( 1 )
-inline vertex_id add_vertex( graph& g )
+template <class Weight>
+inline vertex_id add_vertex( basic_graph<Weight>& g )
 {
     vertex_id v = g.size();
     g.resize( v + 1 );
@@ -51,13 +57,15 @@ inline vertex_id add_vertex( graph& g )
 }
 
 // Return the number of vertices in g
-inline std::size_t count_vertices( graph const& g )
+template <class Weight>
+inline std::size_t count_vertices( basic_graph<Weight> const& g )
 {
     return g.size();
 }
 
 // Return the number of outgoing edges from u in g
-inline std::size_t count_adj( graph const& g, vertex_id u )
+template <class Weight>
+inline std::size_t count_adj( basic_graph<Weight> const& g, vertex_id u )
 {
     return g[u].size();
 }
@@ -65,7 +73,10 @@ inline std::size_t count_adj( graph const& g, vertex_id u )
 // Add an edge in g from u to v with weight w
 // Complexity: O( log(|V|) )
 // Requires: u is a vertex in g, i.e. u < count_vertices( g )
-inline void add_edge( graph& g, vertex_id u, vertex_id v, edge_weight w )
+template <class Weight>
+inline void add_edge(
+    basic_graph<Weight>& g, vertex_id u, vertex_id v,
+    typename basic_graph<Weight>::value_type::mapped_type w )
 {
     assert( u < count_vertices( g ) );
     g[u].insert( std::make_pair( v, w ) );
@@ -100,10 +111,10 @@ struct project1st
 // the sequence of written result values.
 //
 // Complexity: O(|V|)
-template <class OutputIterator>
+template <class Weight, class OutputIterator>
 OutputIterator
 common_neighbors(
-    graph const& g, vertex_id u, vertex_id v, OutputIterator results )
+    basic_graph<Weight> const& g, vertex_id u, vertex_id v, OutputIterator results )
 {
     return std::set_intersection(
         g[u].begin(), g[u].end(), g[v].begin(), g[v].end(),
@@ -111,10 +122,218 @@ common_neighbors(
         );
 }
 
+// A queue of Values keyed by Weight that pops the least key first:
+// a binary heap, ordered by comparing (key, value) pairs.  Unsigned
+// integer keys get the radix heap below instead.
+template <
+    class Weight, class Value,
+    bool Radix = std::numeric_limits<Weight>::is_integer && !std::numeric_limits<Weight>::is_signed
+    >
+class min_queue
+{
+ public:
+    typedef std::pair<Weight, Value> entry;
+
+    bool empty() const { return heap_.empty(); }
+
+    // Complexity: O( log(size) )
+    void push( Weight k, Value const& v )
+    {
+        heap_.push_back( entry( k, v ) );
+        std::push_heap( heap_.begin(), heap_.end(), std::greater<entry>() );
+    }
+
+    // Remove and return an entry with the least key
+    // Complexity: O( log(size) )
+    entry pop()
+    {
+        std::pop_heap( heap_.begin(), heap_.end(), std::greater<entry>() );
+        entry e = heap_.back();
+        heap_.pop_back();
+        return e;
+    }
+
+    // Remove every entry, keeping the storage for reuse
+    void clear() { heap_.clear(); }
+
+ private:
+    // Kept as a heap by the same std::push_heap and std::pop_heap calls
+    // std::priority_queue makes, but open to clear()
+    std::vector<entry> heap_;
+};
+
+// Return the number of bits needed to represent x
+template <class Unsigned>
+inline unsigned bit_width( Unsigned x )
+{
+#ifdef __GNUC__
+    return x ? std::numeric_limits<unsigned long long>::digits - __builtin_clzll( x ) : 0;
+#else
+    unsigned n = 0;
+    for ( ; x; x >>= 1 )
+        ++n;
+    return n;
+#endif
+}
+
+// A monotone radix heap (Ahuja, Mehlhorn, Orlin & Tarjan, "Faster
+// algorithms for the shortest path problem", JACM 1990).  Keys must
+// never be less than the last key popped, which holds for Dijkstra
+// with non-negative weights.  An entry sits in bucket 0 if its key
+// equals the last key popped, and otherwise in bucket b, where b is
+// the bit width of key ^ last.  When bucket 0 runs dry, the lowest
+// non-empty bucket's least key becomes last and that bucket's entries
+// move to lower buckets.  Every key in the heap lies within C of
+// last, where C is the largest edge weight, and an entry only ever
+// moves down, so a push and its pop together cost O( log(C) )
+// amortized: at most one pass per bit of Weight, with no heap
+// sifting.
+template <class Weight, class Value>
+class min_queue<Weight, Value, true>
+{
+ public:
+    typedef std::pair<Weight, Value> entry;
+
+    min_queue() : buckets_( std::numeric_limits<Weight>::digits + 1 ), last_( 0 ), size_( 0 ) {}
+
+    bool empty() const { return size_ == 0; }
+
+    // Requires: k is at least the key last popped
+    void push( Weight k, Value const& v )
+    {
+        assert( k >= last_ );
+        buckets_[bucket( k )].push_back( entry( k, v ) );
+        ++size_;
+    }
+
+    // Remove and return an entry with the least key
+    entry pop()
+    {
+        if ( buckets_[0].empty() )
+        {
+            std::size_t i = 1;
+            while ( buckets_[i].empty() )
+                ++i;
+
+            std::vector<entry>& b = buckets_[i];
+            last_ = b[0].first;
+            for ( std::size_t j = 1; j < b.size(); ++j )
+                last_ = std::min( last_, b[j].first );
+            for ( std::size_t j = 0; j < b.size(); ++j )
+                buckets_[bucket( b[j].first )].push_back( b[j] );
+            b.clear();
+        }
+
+        entry e = buckets_[0].back();
+        buckets_[0].pop_back();
+        --size_;
+        return e;
+    }
+
+    // Remove every entry, keeping the storage for reuse
+    void clear()
+    {
+        for ( std::size_t i = 0; i < buckets_.size(); ++i )
+            buckets_[i].clear();
+        last_ = 0;
+        size_ = 0;
+    }
+
+ private:
+    std::size_t bucket( Weight k ) const
+    {
+        return bit_width( k ^ last_ );
+    }
+
+    std::vector<std::vector<entry> > buckets_;
+    Weight last_;
+    std::size_t size_;
+};
+
+// The distance poor_dijkstra gives vertices it cannot reach: infinity
+// if Weight has one, else Weight's greatest value
+template <class Weight>
+inline Weight unreachable_distance()
+{
+    return std::numeric_limits<Weight>::has_infinity
+        ? std::numeric_limits<Weight>::infinity() : std::numeric_limits<Weight>::max();
+}
+
+// Scratch space poor_dijkstra can reuse from one query to the next.
+// Each vertex's label records the query, or epoch, that last settled
+// it; a label from an earlier epoch reads as unvisited, at infinity,
+// and its own predecessor.  Starting a query therefore costs O( 1 )
+// instead of O( |V| ), and only the vertices a query settles are
+// written.  The queue keeps the storage earlier queries grew.
+template <class Weight>
+class dijkstra_workspace
+{
+ public:
+    dijkstra_workspace() : epoch_( 0 ) {}
+
+    // Begin a query on a graph of n vertices, with every vertex
+    // unvisited
+    void start( std::size_t n )
+    {
+        if ( labels_.size() < n )
+            labels_.resize( n );
+        if ( ++epoch_ == 0 )
+        {
+            // The epoch counter wrapped: forget every old label
+            for ( std::size_t u = 0; u < labels_.size(); ++u )
+                labels_[u].epoch = 0;
+            epoch_ = 1;
+        }
+        queue.clear();
+    }
+
+    // This is "S" from the pseudocode
+    bool visited( vertex_id u ) const { return labels_[u].epoch == epoch_; }
+
+    // Record that the shortest path from s to u has length d and
+    // arrives from p
+    void settle( vertex_id u, Weight d, vertex_id p )
+    {
+        label& l = labels_[u];
+        l.d = d;
+        l.p = p;
+        l.epoch = epoch_;
+    }
+
+    Weight distance( vertex_id u ) const
+    {
+        return visited( u ) ? labels_[u].d : unreachable_distance<Weight>();
+    }
+
+    vertex_id predecessor( vertex_id u ) const
+    {
+        return visited( u ) ? labels_[u].p : u;
+    }
+
+    // The queue of (cost, (t, u)) paths still to be examined
+    min_queue<Weight, std::pair<vertex_id, vertex_id> > queue;
+
+ private:
+    struct label
+    {
+        label() : d(), p(), epoch( 0 ) {}
+        Weight d;
+        vertex_id p;
+        unsigned epoch;
+    };
+
+    std::vector<label> labels_;
+    unsigned epoch_;
+};
+
 // Compute the shortest path from s to dst, writing the ids of
 // vertices on the path (excluding s), in reverse order, into
 // out_path.  Return a pair consisting of the total path cost and the
-// resulting value of out_path.
+// resulting value of out_path.  Q is a min_queue, so the choice
+// between a comparison heap and a radix heap is made at compile time
+// from the graph's weight type.  Integer path costs must fit in
+// Weight.  All scratch space comes from w, which may be reused for
+// any number of queries.
 //
 // Pseudocode:
 //
@@ -136,82 +355,78 @@ common_neighbors(
 //       end for 
 //   end while
 //
-template <class OutputIterator>
-std::pair<edge_weight,OutputIterator>
-poor_dijkstra( graph const& g, vertex_id s, vertex_id dst, OutputIterator out_path )
+template <class Weight, class OutputIterator>
+std::pair<Weight,OutputIterator>
+poor_dijkstra(
+    basic_graph<Weight> const& g, vertex_id s, vertex_id dst, OutputIterator out_path,
+    dijkstra_workspace<Weight>& w )
 {
-    // This is "S" from the pseudocode
-    std::vector<bool> visited( count_vertices( g ) );
-    
-    // shortest distance to each vertex starts at infinity
-    std::vector<edge_weight> d(
-        count_vertices( g ), std::numeric_limits<edge_weight>::infinity() );
-    
-    // Each vertex starts as its own predecessor in shortest path from s
-    std::vector<vertex_id> p( count_vertices( g ) );
-    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
-        p[u] = u;
+    // Every vertex starts unvisited, at infinity, and as its own
+    // predecessor in shortest path from s
+    w.start( count_vertices( g ) );
     
     // An edge is a pair of vertices
     typedef std::pair<vertex_id, vertex_id> edge;
     
     // A weighted edge is an edge weight plus an edge
-    typedef std::pair<edge_weight, edge> weighted_edge;
+    typedef std::pair<Weight, edge> weighted_edge;
 
-    // Priority queue adapts a vector of weighted_edge and uses
-    // std::greater to ensure highest-cost paths have the lowest priority.
-    std::priority_queue<
-      weighted_edge, std::vector<weighted_edge>, std::greater<weighted_edge>
-    > q;
+    // The queue hands out the cheapest paths first
+    min_queue<Weight, edge>& q = w.queue;
       
-    q.push( std::make_pair( 0.0, std::make_pair( s, s ) ) );
+    q.push( Weight( 0 ), std::make_pair( s, s ) );
 
     while ( !q.empty() )
     {
         // grab the t,u,x triple from the top of the queue
-        weighted_edge const& tux = q.top();
+        weighted_edge const tux = q.pop();
         vertex_id const t = tux.second.first, u = tux.second.second;
-        edge_weight const x = tux.first;
-        q.pop();
+        Weight const x = tux.first;
         
-        if ( !visited[u] )
+        if ( !w.visited( u ) )
         {
-            d[u] = x;
-            p[u] = t;
-            visited[u] = true;
+            w.settle( u, x, t );
             
-            for (neighbors_t::const_iterator adj = g[u].begin(), last = g[u].end();
+            for (typename basic_graph<Weight>::value_type::const_iterator
+                     adj = g[u].begin(), last = g[u].end();
                  adj != last;
                  ++adj)
             {
-                if ( !visited[adj->first] )
+                if ( !w.visited( adj->first ) )
                 {
-                    q.push(
-                        weighted_edge( x + adj->second, std::make_pair( u, adj->first )
-                            )
-                        );
+                    q.push( x + adj->second, std::make_pair( u, adj->first ) );
                 }
             }
         }
     }
 
     // Get the total cost of the shortest path
-    edge_weight w = d[ dst ];
+    Weight cost = w.distance( dst );
 
     // Walk backwards from dst until we find a self-loop, writing out
     // vertices along the way.
-    while ( p[dst] != dst )
+    while ( w.predecessor( dst ) != dst )
     {
         *out_path++ = dst;
-        dst = p[dst];
+        dst = w.predecessor( dst );
     }
 
     // Return total cost plus new iterator
-    return std::make_pair( w, out_path );
+    return std::make_pair( cost, out_path );
+}
+
+// As above, with scratch space for just this query
+template <class Weight, class OutputIterator>
+std::pair<Weight,OutputIterator>
+poor_dijkstra( basic_graph<Weight> const& g, vertex_id s, vertex_id dst, OutputIterator out_path )
+{
+    dijkstra_workspace<Weight> w;
+    return poor_dijkstra( g, s, dst, out_path, w );
 }
 
 // Read a graph from input in adjacency list form.
-void read_adjacency_list( std::istream& input, graph& g )
+template <class Weight>
+void read_adjacency_list( std::istream& input, basic_graph<Weight>& g )
 {
     for ( std::string line; std::getline(input, line); )
     {
@@ -220,30 +435,68 @@ void read_adjacency_list( std::istream& input, graph& g )
         std::stringstream s(line);
         for ( int dst; s >> dst; )
         {
-            // Make up an arbitrary weight
-            edge_weight w = (1 + count_adj(g, src)) * 1.0 / count_vertices(g);
-            add_edge( g, src, dst, w );
+            // Make up an arbitrary weight; integer weights keep only
+            // the numerator
+            double w = 1 + count_adj(g, src);
+            if ( !std::numeric_limits<Weight>::is_integer )
+                w /= count_vertices(g);
+            add_edge( g, src, dst, Weight( w ) );
         }
     }
 }
 
-// Write a g to output in adjacency matrix form.
-void write_adjacency_matrix( std::ostream& output, graph const& g )
+// Output is collected in a std::string and handed to the stream in
+// blocks of about this many bytes, rather than flushed line by line.
+std::size_t const output_block_size = 1 << 16;
+
+// Write buf to output and empty it if it has reached
+// output_block_size, or unconditionally if force is true
+inline void flush_output( std::ostream& output, std::string& buf, bool force = false )
+{
+    if ( force || buf.size() >= output_block_size )
+    {
+        output.write( buf.data(), buf.size() );
+        buf.clear();
+    }
+}
+
+// Write a g to output in adjacency matrix form.  Each row starts as
+// a copy of an empty row and gets a '*' for each of the row's
+// neighbors, so no has_edge lookups are needed.
+// Complexity: O( |V|^2 + |E| ), with the |V|^2 term spent copying
+// whole rows
+template <class Weight>
+void write_adjacency_matrix( std::ostream& output, basic_graph<Weight> const& g )
 {
+    std::string empty_row;
+    for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+        empty_row += ". ";
+    empty_row += '\n';
+
+    std::string buf;
     for ( vertex_id u = 0; u < count_vertices( g ); ++u )
     {
-        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
-            output << (has_edge( g, u, v ) ? "* " : ". ");
-        output << std::endl;
+        std::size_t row = buf.size();
+        buf += empty_row;
+        for ( typename basic_graph<Weight>::value_type::const_iterator
+                  p = g[u].begin(), e = g[u].end(); p != e; ++p )
+            if ( p->first < count_vertices( g ) )
+                buf[row + 2 * p->first] = '*';
+        flush_output( output, buf );
     }
+    flush_output( output, buf, true );
 }
 
 #include <iostream>
 int main( int argc, char *argv[] )
 {
-    graph g;
+    // Keep the input so it can be read a second time with integer weights
+    std::string text(
+        (std::istreambuf_iterator<char>( std::cin )), std::istreambuf_iterator<char>() );
 
-    read_adjacency_list( std::cin, g );
+    graph g;
+    std::istringstream input( text );
+    read_adjacency_list( input, g );
     write_adjacency_matrix( std::cout, g );
     
     if ( argc == 3 )
@@ -268,6 +521,16 @@ int main( int argc, char *argv[] )
             g, u, v,
             std::ostream_iterator<vertex_id>( std::cout, " " ) ).first;
         std::cout << "has length: " << w << std::endl;
+
+        basic_graph<unsigned> ig;
+        std::istringstream int_input( text );
+        read_adjacency_list( int_input, ig );
+
+        std::cout << "with unsigned weights: ";
+        unsigned iw = poor_dijkstra(
+            ig, u, v,
+            std::ostream_iterator<vertex_id>( std::cout, " " ) ).first;
+        std::cout << "has length: " << iw << std::endl;
     }
 }
 
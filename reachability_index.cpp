@@ -0,0 +1,539 @@
+/*
+    g++ -O2 reachability_index.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g 2 0 1 0 0 4 3 5
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    vertex 0 is reachable from vertex 2
+    vertex 0 is not reachable from vertex 1
+    vertex 4 is reachable from vertex 0
+    vertex 5 is reachable from vertex 3
+    6 vertices in 2 components, 1 dag edges, 5 labels each
+    index: ... bytes, built in ... ms
+    4 queries: 4 answered by labels, 0 by search, ... us per query (bfs: ... us)
+
+Notes:
+strongly connected components are condensed first: every vertex of a
+component reaches every other, so queries become questions about a DAG
+each of k randomized depth-first traversals of the DAG labels every
+component with an interval [low, post]; if u reaches v then v's
+interval lies inside u's in every traversal (GRAIL: Yildirim, Chaoji &
+Zaki, "GRAIL: Scalable Reachability Index for Large Graphs", VLDB 2010)
+so one missing containment proves "not reachable", and being inside
+u's subtree of the first traversal's DFS tree proves "reachable"
+everything else falls back to a depth-first search that skips any
+component whose labels exclude the target
+
+ */
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <deque>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <random>
+#include <chrono>
+
+// Adjacency list graph representation
+typedef unsigned vertex_id;
+typedef float edge_weight;
+typedef std::map<vertex_id, edge_weight> neighbors_t;
+typedef std::vector<neighbors_t> graph;
+
+// Add a vertex to g and return its id
+// Complexity: O( 1 )
+inline vertex_id add_vertex( graph& g )
+{
+    vertex_id v = g.size();
+    g.resize( v + 1 );
+    return v;
+}
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( graph const& g )
+{
+    return g.size();
+}
+
+// Return the number of outgoing edges from u in g
+inline std::size_t count_adj( graph const& g, vertex_id u )
+{
+    return g[u].size();
+}
+
+// True iff there is an edge in g from u to v
+// Complexity: O( log(|V|) )
+inline bool has_edge(graph const& g, int u, int v)
+{
+    return g[u].find(v) != g[u].end();
+}
+
+// Add an edge in g from u to v with weight w
+// Complexity: O( log(|V|) )
+// Requires: u is a vertex in g, i.e. u < count_vertices( g )
+inline void add_edge( graph& g, vertex_id u, vertex_id v, edge_weight w )
+{
+    assert( u < count_vertices( g ) );
+    g[u].insert( std::make_pair( v, w ) );
+}
+
+// Return the strongly connected component of each vertex of g, and
+// set count to the number of components.  Components are numbered in
+// the order Tarjan's algorithm completes them, which is a reverse
+// topological order: if any edge leads from component a to a
+// different component b, then a > b.
+// Complexity: O( |V| + |E| )
+std::vector<vertex_id> strong_components( graph const& g, std::size_t& count )
+{
+    std::size_t const n = count_vertices( g );
+    unsigned const unvisited = std::numeric_limits<unsigned>::max();
+    std::vector<unsigned> index( n, unvisited ), low( n );
+    std::vector<bool> on_stack( n );
+    std::vector<vertex_id> comp( n ), stack;
+
+    // The depth-first search path: each vertex with its next edge
+    std::vector<std::pair<vertex_id, neighbors_t::const_iterator> > path;
+    unsigned next_index = 0;
+    count = 0;
+
+    for ( vertex_id root = 0; root < n; ++root )
+    {
+        if ( index[root] != unvisited )
+            continue;
+
+        index[root] = low[root] = next_index++;
+        stack.push_back( root );
+        on_stack[root] = true;
+        path.push_back( std::make_pair( root, g[root].begin() ) );
+
+        while ( !path.empty() )
+        {
+            vertex_id u = path.back().first;
+            neighbors_t::const_iterator& p = path.back().second;
+            if ( p != g[u].end() )
+            {
+                vertex_id v = (p++)->first;
+                if ( index[v] == unvisited )
+                {
+                    index[v] = low[v] = next_index++;
+                    stack.push_back( v );
+                    on_stack[v] = true;
+                    path.push_back( std::make_pair( v, g[v].begin() ) );
+                }
+                else if ( on_stack[v] )
+                    low[u] = std::min( low[u], index[v] );
+                continue;
+            }
+
+            // u is finished; pop its component if it is the root of one
+            path.pop_back();
+            if ( !path.empty() )
+                low[path.back().first] = std::min( low[path.back().first], low[u] );
+            if ( low[u] == index[u] )
+            {
+                vertex_id v;
+                do
+                {
+                    v = stack.back();
+                    stack.pop_back();
+                    on_stack[v] = false;
+                    comp[v] = count;
+                }
+                while ( v != u );
+                ++count;
+            }
+        }
+    }
+    return comp;
+}
+
+// An interval label [low, post] of one DAG traversal
+struct interval
+{
+    unsigned low;
+    unsigned post;
+};
+
+// True iff inner lies within outer
+inline bool contains( interval outer, interval inner )
+{
+    return outer.low <= inner.low && inner.post <= outer.post;
+}
+
+// A reachability index of a graph that answers "is v reachable from
+// u?" mostly by comparing labels.
+struct reachability_index
+{
+    // The condensed component of each vertex
+    std::vector<vertex_id> comp;
+
+    // The DAG of components, in compressed sparse row form: the edges
+    // leaving component c go to dag_targets[dag_offsets[c]] ..
+    // dag_targets[dag_offsets[c+1]-1]
+    std::vector<std::size_t> dag_offsets;
+    std::vector<vertex_id> dag_targets;
+
+    // labels[c * k + i] is component c's label in traversal i
+    unsigned k;
+    std::vector<interval> labels;
+
+    // Preorder number and subtree end of each component in the DFS
+    // tree of traversal 0; d lies in c's subtree iff
+    // pre[c] <= pre[d] < tree_end[c]
+    std::vector<unsigned> pre;
+    std::vector<unsigned> tree_end;
+};
+
+// Return the number of components in x
+inline std::size_t count_components( reachability_index const& x )
+{
+    return x.dag_offsets.size() - 1;
+}
+
+// Return the number of bytes used by x's arrays
+std::size_t memory_bytes( reachability_index const& x )
+{
+    return x.comp.size() * sizeof( vertex_id )
+        + x.dag_offsets.size() * sizeof( std::size_t )
+        + x.dag_targets.size() * sizeof( vertex_id )
+        + x.labels.size() * sizeof( interval )
+        + (x.pre.size() + x.tree_end.size()) * sizeof( unsigned );
+}
+
+// Label every component of x by a depth-first traversal of the DAG
+// with i as the traversal number.  Roots are taken in a random order,
+// and each component's children from a random starting point.
+// Traversal 0 also records the DFS tree in pre and tree_end.
+void label_traversal( reachability_index& x, unsigned i, std::mt19937& random )
+{
+    std::size_t const n = count_components( x );
+    unsigned const unvisited = std::numeric_limits<unsigned>::max();
+
+    // Roots of the DAG are components with no incoming edges
+    std::vector<bool> has_parent( n );
+    for ( std::size_t e = 0; e < x.dag_targets.size(); ++e )
+        has_parent[x.dag_targets[e]] = true;
+    std::vector<vertex_id> roots;
+    for ( vertex_id c = 0; c < n; ++c )
+        if ( !has_parent[c] )
+            roots.push_back( c );
+    std::shuffle( roots.begin(), roots.end(), random );
+
+    std::vector<unsigned> post( n, unvisited );
+    std::vector<bool> started( n );
+    unsigned next_post = 0, next_pre = 0;
+
+    // Each path entry is a component, its first child index, and how
+    // many of its children have been visited
+    struct step { vertex_id c; std::size_t start, done; };
+    std::vector<step> path;
+
+    for ( std::size_t r = 0; r < roots.size(); ++r )
+    {
+        vertex_id root = roots[r];
+        started[root] = true;
+        if ( i == 0 )
+            x.pre[root] = next_pre++;
+        step s = { root, 0, 0 };
+        std::size_t degree = x.dag_offsets[root + 1] - x.dag_offsets[root];
+        s.start = degree ? random() % degree : 0;
+        path.push_back( s );
+
+        while ( !path.empty() )
+        {
+            step& top = path.back();
+            std::size_t first = x.dag_offsets[top.c], degree = x.dag_offsets[top.c + 1] - first;
+            if ( top.done != degree )
+            {
+                vertex_id d = x.dag_targets[first + (top.start + top.done++) % degree];
+                if ( !started[d] )
+                {
+                    started[d] = true;
+                    if ( i == 0 )
+                        x.pre[d] = next_pre++;
+                    std::size_t d_degree = x.dag_offsets[d + 1] - x.dag_offsets[d];
+                    step s = { d, d_degree ? random() % d_degree : 0, 0 };
+                    path.push_back( s );
+                }
+                continue;
+            }
+
+            // All children are finished: low is the least low of c and
+            // every child, including those reached through other parents
+            vertex_id c = top.c;
+            path.pop_back();
+            interval& label = x.labels[c * x.k + i];
+            label.post = next_post++;
+            label.low = label.post;
+            for ( std::size_t e = first; e < first + degree; ++e )
+                label.low = std::min( label.low, x.labels[x.dag_targets[e] * x.k + i].low );
+            if ( i == 0 )
+                x.tree_end[c] = next_pre;
+        }
+    }
+}
+
+// Build a reachability index of g with k label traversals
+// Complexity: O( k x (|V| + |E|) + |E| log(|E|) )
+reachability_index make_reachability_index( graph const& g, unsigned k = 5, unsigned seed = 1 )
+{
+    reachability_index x;
+    std::size_t n;
+    x.comp = strong_components( g, n );
+
+    // Collect the edges between components, without duplicates
+    std::vector<std::pair<vertex_id, vertex_id> > edges;
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+            if ( x.comp[u] != x.comp[p->first] )
+                edges.push_back( std::make_pair( x.comp[u], x.comp[p->first] ) );
+    std::sort( edges.begin(), edges.end() );
+    edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+
+    x.dag_offsets.assign( n + 1, 0 );
+    for ( std::size_t e = 0; e < edges.size(); ++e )
+    {
+        ++x.dag_offsets[edges[e].first + 1];
+        x.dag_targets.push_back( edges[e].second );
+    }
+    for ( std::size_t c = 0; c < n; ++c )
+        x.dag_offsets[c + 1] += x.dag_offsets[c];
+
+    x.k = std::max( 1u, k );
+    x.labels.resize( n * x.k );
+    x.pre.resize( n );
+    x.tree_end.resize( n );
+    std::mt19937 random( seed );
+    for ( unsigned i = 0; i < x.k; ++i )
+        label_traversal( x, i, random );
+    return x;
+}
+
+// True iff the labels of component c allow it to reach component d
+inline bool may_reach( reachability_index const& x, vertex_id c, vertex_id d )
+{
+    if ( c < d )
+        return false;   // components are numbered in reverse topological order
+    for ( unsigned i = 0; i < x.k; ++i )
+        if ( !contains( x.labels[c * x.k + i], x.labels[d * x.k + i] ) )
+            return false;
+    return true;
+}
+
+// Scratch space for the fallback searches of reachable, reused from
+// one query to the next, and counts of how queries were answered.
+// Each component's visited mark is valid only if it equals the current
+// query's number, or epoch, so starting a search costs O( 1 ) instead
+// of O( |components| ).  The index itself is never written by a query,
+// so threads may share one index as long as each has its own
+// workspace.
+class reachability_workspace
+{
+ public:
+    reachability_workspace() : by_labels( 0 ), by_search( 0 ), epoch_( 0 ) {}
+
+    // Begin a search of a DAG of n components, with every component
+    // unvisited and the stack empty
+    void start( std::size_t n )
+    {
+        if ( marks_.size() < n )
+            marks_.resize( n );
+        if ( ++epoch_ == 0 )
+        {
+            // The epoch counter wrapped: forget every old mark
+            std::fill( marks_.begin(), marks_.end(), 0 );
+            epoch_ = 1;
+        }
+        stack.clear();
+    }
+
+    bool visited( vertex_id c ) const { return marks_[c] == epoch_; }
+
+    void visit( vertex_id c ) { marks_[c] = epoch_; }
+
+    // Components waiting to be expanded
+    std::vector<vertex_id> stack;
+
+    // The number of queries the labels decided, and the number that
+    // needed a search
+    std::size_t by_labels;
+    std::size_t by_search;
+
+ private:
+    std::vector<unsigned> marks_;
+    unsigned epoch_;
+};
+
+// True iff v is reachable from u in the graph x indexes, using w for
+// all scratch space.
+// Complexity: O( k ) when the labels decide; otherwise a depth-first
+// search of the DAG that never enters a component whose labels rule
+// out the target.
+bool reachable( reachability_index const& x, vertex_id u, vertex_id v, reachability_workspace& w )
+{
+    vertex_id const c = x.comp[u], d = x.comp[v];
+    if ( c == d )
+    {
+        ++w.by_labels;
+        return true;
+    }
+    if ( !may_reach( x, c, d ) )
+    {
+        ++w.by_labels;
+        return false;
+    }
+    if ( x.pre[c] <= x.pre[d] && x.pre[d] < x.tree_end[c] )
+    {
+        ++w.by_labels;
+        return true;
+    }
+
+    ++w.by_search;
+    w.start( count_components( x ) );
+    std::vector<vertex_id>& stack = w.stack;
+    stack.push_back( c );
+    w.visit( c );
+    while ( !stack.empty() )
+    {
+        vertex_id a = stack.back();
+        stack.pop_back();
+        for ( std::size_t e = x.dag_offsets[a]; e < x.dag_offsets[a + 1]; ++e )
+        {
+            vertex_id b = x.dag_targets[e];
+            if ( b == d )
+                return true;
+            if ( !w.visited( b ) && may_reach( x, b, d ) )
+            {
+                w.visit( b );
+                stack.push_back( b );
+            }
+        }
+    }
+    return false;
+}
+
+// True iff v is reachable from u in the graph x indexes
+bool reachable( reachability_index const& x, vertex_id u, vertex_id v )
+{
+    reachability_workspace w;
+    return reachable( x, u, v, w );
+}
+
+// A simple breadth-first search starting from u for vertex v.
+// Returns true iff v is reachable from u.  Complexity: O(|V|+|E|)
+bool bfs( graph const& g, vertex_id u, vertex_id v )
+{
+    std::vector<bool> visited( count_vertices( g ) );
+    std::deque<vertex_id> q( 1, u );
+    visited[u] = true;
+
+    while ( !q.empty() )
+    {
+        vertex_id const next = q.front();
+        q.pop_front();
+        if ( next == v )
+            return true;
+        for ( neighbors_t::const_iterator p = g[next].begin(), e = g[next].end(); p != e; ++p )
+        {
+            if ( !visited[p->first] )
+            {
+                visited[p->first] = true;
+                q.push_back( p->first );
+            }
+        }
+    }
+    return false;
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = add_vertex( g );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + count_adj(g, src)) * 1.0 / count_vertices(g);
+            add_edge( g, src, dst, w );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, graph const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (has_edge( g, u, v ) ? "* " : ". ");
+        output << '\n';
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    typedef std::chrono::steady_clock clock;
+    graph g;
+
+    read_adjacency_list( std::cin, g );
+    write_adjacency_matrix( std::cout, g );
+
+    clock::time_point start = clock::now();
+    reachability_index x = make_reachability_index( g );
+    double build_ms = std::chrono::duration<double, std::milli>( clock::now() - start ).count();
+
+    std::vector<std::pair<vertex_id, vertex_id> > queries;
+    for ( int i = 1; i + 1 < argc; i += 2 )
+    {
+        std::pair<vertex_id, vertex_id> q;
+        std::stringstream(argv[i]) >> q.first;
+        std::stringstream(argv[i + 1]) >> q.second;
+        queries.push_back( q );
+    }
+
+    std::vector<bool> answers( queries.size() );
+    reachability_workspace w;
+    start = clock::now();
+    for ( std::size_t i = 0; i < queries.size(); ++i )
+        answers[i] = reachable( x, queries[i].first, queries[i].second, w );
+    double query_us = std::chrono::duration<double, std::micro>( clock::now() - start ).count();
+
+    start = clock::now();
+    for ( std::size_t i = 0; i < queries.size(); ++i )
+    {
+        bool r = bfs( g, queries[i].first, queries[i].second );
+        assert( r == answers[i] );
+        (void)r;
+    }
+    double bfs_us = std::chrono::duration<double, std::micro>( clock::now() - start ).count();
+
+    for ( std::size_t i = 0; i < queries.size(); ++i )
+        std::cout << "vertex " << queries[i].second << " is " << (answers[i] ? "" : "not ")
+                  << "reachable from vertex " << queries[i].first << std::endl;
+
+    std::cout << count_vertices( g ) << " vertices in " << count_components( x )
+              << " components, " << x.dag_targets.size() << " dag edges, "
+              << x.k << " labels each" << std::endl;
+    std::cout << "index: " << memory_bytes( x ) << " bytes, built in " << build_ms << " ms"
+              << std::endl;
+    if ( !queries.empty() )
+        std::cout << queries.size() << " queries: " << w.by_labels << " answered by labels, "
+                  << w.by_search << " by search, " << query_us / queries.size()
+                  << " us per query (bfs: " << bfs_us / queries.size() << " us)" << std::endl;
+}
@@ -0,0 +1,479 @@
+/*
+    g++ -O2 reorder_vertices.cpp -o g
+    echo "2
+
+    4 5 1
+    0
+    3 1
+    3 0" | ./g rcm 2 0
+    . . * . . .
+    . . . . . .
+    . * . . * *
+    * . . . . .
+    . * . * . .
+    * . . * . .
+    rcm order, old -> new: 0->1 1->5 2->3 3->2 4->4 5->0
+    . * * . . .
+    . . . * . .
+    . * . . . .
+    * . . . * *
+    . . * . . *
+    . . . . . .
+    vertex 0 is reachable from vertex 2
+    original bfs: ... us, reordered bfs: ... us (best of 9)
+
+Notes:
+a permutation maps each old vertex id to its new id
+relabel rewrites a graph under a permutation
+callers translate query ids at the boundary with the same permutation
+
+ */
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <deque>
+#include <iterator>
+#include <algorithm>
+#include <map>
+#include <chrono>
+#include <limits>
+
+typedef unsigned vertex_id;
+typedef float edge_weight;
+
+// Adjacency list graph representation (see edge_list_solution.cpp)
+typedef std::vector<vertex_id> neighbors_t;
+typedef std::vector<neighbors_t> adjacency_list;
+
+// Edge list graph representation (see edge_list_solution.cpp)
+typedef std::pair<vertex_id, vertex_id> edge;
+typedef std::vector<edge> edge_list;
+
+// Weighted adjacency list graph representation (see map_bfs_solution.cpp)
+typedef std::map<vertex_id, edge_weight> weighted_neighbors_t;
+typedef std::vector<weighted_neighbors_t> graph;
+
+// A relabeling of vertices: vertex u is renamed to perm[u]
+typedef std::vector<vertex_id> permutation;
+
+// Return the number of vertices in g
+inline std::size_t count_vertices( adjacency_list const& g )
+{
+    return g.size();
+}
+
+// Return the permutation that undoes perm
+// Complexity: O( |V| )
+permutation inverse_permutation( permutation const& perm )
+{
+    permutation result( perm.size() );
+    for ( vertex_id u = 0; u < perm.size(); ++u )
+        result[perm[u]] = u;
+    return result;
+}
+
+// Return the permutation that renames order[0] to 0, order[1] to 1...
+permutation permutation_from_order( std::vector<vertex_id> const& order )
+{
+    return inverse_permutation( order );
+}
+
+// Return an adjacency_list with the same edges as g, ignoring weights
+// Complexity: O( |V| + |E| )
+adjacency_list make_adjacency_list( graph const& g )
+{
+    adjacency_list result( g.size() );
+    for ( vertex_id u = 0; u < g.size(); ++u )
+    {
+        result[u].reserve( g[u].size() );
+        for ( weighted_neighbors_t::const_iterator p = g[u].begin(), e = g[u].end();
+              p != e; ++p )
+            result[u].push_back( p->first );
+    }
+    return result;
+}
+
+// Return the undirected view of g: an edge each way for every edge
+// Complexity: O( |V| + |E| log(|V|) )
+adjacency_list symmetrized( adjacency_list const& g )
+{
+    adjacency_list result( g );
+    for ( vertex_id u = 0; u < g.size(); ++u )
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+            result[*p].push_back( u );
+
+    for ( vertex_id u = 0; u < result.size(); ++u )
+    {
+        std::sort( result[u].begin(), result[u].end() );
+        result[u].erase( std::unique( result[u].begin(), result[u].end() ), result[u].end() );
+    }
+    return result;
+}
+
+// A function object that orders vertices by decreasing out-degree
+struct more_adjacent
+{
+    adjacency_list const* g;
+
+    // Complexity: O( 1 )
+    bool operator()( vertex_id u, vertex_id v ) const
+    {
+        return (*g)[u].size() > (*g)[v].size();
+    }
+};
+
+// A function object that orders vertices by increasing out-degree
+struct fewer_adjacent
+{
+    adjacency_list const* g;
+
+    // Complexity: O( 1 )
+    bool operator()( vertex_id u, vertex_id v ) const
+    {
+        return (*g)[u].size() < (*g)[v].size();
+    }
+};
+
+// Return the permutation that numbers vertices by decreasing
+// out-degree, so the hubs that most traversals touch share cache
+// lines.  Ties keep their original relative order.
+// Complexity: O( |V| log(|V|) )
+permutation degree_order( adjacency_list const& g )
+{
+    std::vector<vertex_id> order( count_vertices( g ) );
+    for ( vertex_id u = 0; u < order.size(); ++u )
+        order[u] = u;
+    more_adjacent by_degree = { &g };
+    std::stable_sort( order.begin(), order.end(), by_degree );
+    return permutation_from_order( order );
+}
+
+// Return the permutation that numbers vertices in the order a
+// breadth-first search discovers them, restarting from the lowest
+// unnumbered vertex until every vertex is numbered.  Vertices on the
+// same frontier end up adjacent in memory.
+// Complexity: O( |V| + |E| )
+permutation bfs_order( adjacency_list const& g )
+{
+    std::vector<vertex_id> order;
+    order.reserve( count_vertices( g ) );
+    std::vector<bool> visited( count_vertices( g ) );
+
+    for ( vertex_id root = 0; root < count_vertices( g ); ++root )
+    {
+        if ( visited[root] )
+            continue;
+
+        // order doubles as the queue: [head, order.size()) is the frontier
+        visited[root] = true;
+        std::size_t head = order.size();
+        order.push_back( root );
+        for ( ; head != order.size(); ++head )
+        {
+            vertex_id u = order[head];
+            for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+            {
+                if ( !visited[*p] )
+                {
+                    visited[*p] = true;
+                    order.push_back( *p );
+                }
+            }
+        }
+    }
+    return permutation_from_order( order );
+}
+
+// Return the permutation that numbers vertices in depth-first
+// preorder, restarting from the lowest unnumbered vertex until every
+// vertex is numbered.
+// Complexity: O( |V| + |E| )
+permutation dfs_order( adjacency_list const& g )
+{
+    std::vector<vertex_id> order;
+    order.reserve( count_vertices( g ) );
+    std::vector<bool> visited( count_vertices( g ) );
+
+    // Each stack entry is a vertex and the index of its next neighbor
+    std::vector<std::pair<vertex_id, std::size_t> > stack;
+
+    for ( vertex_id root = 0; root < count_vertices( g ); ++root )
+    {
+        if ( visited[root] )
+            continue;
+
+        visited[root] = true;
+        order.push_back( root );
+        stack.push_back( std::make_pair( root, 0 ) );
+        while ( !stack.empty() )
+        {
+            vertex_id u = stack.back().first;
+            std::size_t& i = stack.back().second;
+            if ( i == g[u].size() )
+            {
+                stack.pop_back();
+                continue;
+            }
+
+            vertex_id v = g[u][i++];
+            if ( !visited[v] )
+            {
+                visited[v] = true;
+                order.push_back( v );
+                stack.push_back( std::make_pair( v, 0 ) );
+            }
+        }
+    }
+    return permutation_from_order( order );
+}
+
+// Return the Reverse Cuthill-McKee permutation of g, which reduces
+// the bandwidth of the adjacency matrix (how far edges stray from the
+// diagonal).  The edges are treated as undirected.  Each component is
+// searched breadth-first from its vertex of least degree, visiting
+// neighbors by increasing degree; the final order is reversed.
+// Complexity: O( |V| log(|V|) + |E| log(|V|) )
+permutation rcm_order( adjacency_list const& directed )
+{
+    adjacency_list const g = symmetrized( directed );
+    fewer_adjacent by_degree = { &g };
+
+    std::vector<vertex_id> by_least_degree( count_vertices( g ) );
+    for ( vertex_id u = 0; u < by_least_degree.size(); ++u )
+        by_least_degree[u] = u;
+    std::stable_sort( by_least_degree.begin(), by_least_degree.end(), by_degree );
+
+    std::vector<vertex_id> order;
+    order.reserve( count_vertices( g ) );
+    std::vector<bool> visited( count_vertices( g ) );
+    neighbors_t next;
+
+    for ( std::size_t r = 0; r < by_least_degree.size(); ++r )
+    {
+        vertex_id root = by_least_degree[r];
+        if ( visited[root] )
+            continue;
+
+        visited[root] = true;
+        std::size_t head = order.size();
+        order.push_back( root );
+        for ( ; head != order.size(); ++head )
+        {
+            vertex_id u = order[head];
+            next.clear();
+            for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+            {
+                if ( !visited[*p] )
+                {
+                    visited[*p] = true;
+                    next.push_back( *p );
+                }
+            }
+            std::stable_sort( next.begin(), next.end(), by_degree );
+            order.insert( order.end(), next.begin(), next.end() );
+        }
+    }
+    std::reverse( order.begin(), order.end() );
+    return permutation_from_order( order );
+}
+
+// Return g with every vertex u renamed to perm[u]
+// Complexity: O( |V| + |E| log(|V|) )
+adjacency_list relabel( adjacency_list const& g, permutation const& perm )
+{
+    assert( perm.size() == count_vertices( g ) );
+    adjacency_list result( count_vertices( g ) );
+    for ( vertex_id u = 0; u < g.size(); ++u )
+    {
+        neighbors_t& row = result[perm[u]];
+        row.reserve( g[u].size() );
+        for ( neighbors_t::const_iterator p = g[u].begin(), e = g[u].end(); p != e; ++p )
+            row.push_back( perm[*p] );
+        std::sort( row.begin(), row.end() );
+    }
+    return result;
+}
+
+// Complexity: O( |E| log(|E|) )
+edge_list relabel( edge_list const& g, permutation const& perm )
+{
+    // An edge_list has as many vertices as its largest endpoint needs
+    std::size_t vcnt = 0;
+    for ( edge_list::const_iterator p = g.begin(), e = g.end(); p != e; ++p )
+        vcnt = std::max( vcnt, std::size_t( std::max( p->first, p->second ) ) + 1 );
+    assert( perm.size() >= vcnt );
+
+    edge_list result;
+    result.reserve( g.size() );
+    for ( edge_list::const_iterator p = g.begin(), e = g.end(); p != e; ++p )
+        result.push_back( edge( perm[p->first], perm[p->second] ) );
+    std::sort( result.begin(), result.end() );
+    return result;
+}
+
+// Complexity: O( |V| + |E| log(|V|) )
+graph relabel( graph const& g, permutation const& perm )
+{
+    assert( perm.size() == g.size() );
+    graph result( g.size() );
+    for ( vertex_id u = 0; u < g.size(); ++u )
+    {
+        weighted_neighbors_t& row = result[perm[u]];
+        for ( weighted_neighbors_t::const_iterator p = g[u].begin(), e = g[u].end();
+              p != e; ++p )
+            row.insert( std::make_pair( perm[p->first], p->second ) );
+    }
+    return result;
+}
+
+// Return the named ordering of g: one of "degree", "bfs", "dfs" or
+// "rcm".  Any other name yields the identity.
+permutation vertex_order( adjacency_list const& g, std::string const& name )
+{
+    if ( name == "degree" )
+        return degree_order( g );
+    if ( name == "bfs" )
+        return bfs_order( g );
+    if ( name == "dfs" )
+        return dfs_order( g );
+    if ( name == "rcm" )
+        return rcm_order( g );
+
+    permutation identity( count_vertices( g ) );
+    for ( vertex_id u = 0; u < identity.size(); ++u )
+        identity[u] = u;
+    return identity;
+}
+
+// A simple breadth-first search starting from u for vertex v.
+// Returns true iff v is reachable from u.  Complexity: O(|V|+|E|)
+bool bfs( adjacency_list const& g, vertex_id u, vertex_id v )
+{
+    std::vector<bool> visited( count_vertices( g ) );
+    std::deque<vertex_id> q;
+    q.push_back( u );
+
+    while ( !q.empty() )
+    {
+        vertex_id const next = q.front();
+        q.pop_front();
+        if ( next == v )
+            return true;
+        if ( !visited[next] )
+        {
+            visited[next] = true;
+            q.insert( q.end(), g[next].begin(), g[next].end() );
+        }
+    }
+    return false;
+}
+
+// Read a graph from input in adjacency list form.
+void read_adjacency_list( std::istream& input, graph& g )
+{
+    for ( std::string line; std::getline(input, line); )
+    {
+        vertex_id src = g.size();
+        g.resize( src + 1 );
+
+        std::stringstream s(line);
+        for ( int dst; s >> dst; )
+        {
+            // Make up an arbitrary weight
+            edge_weight w = (1 + g[src].size()) * 1.0 / g.size();
+            g[src].insert( std::make_pair( vertex_id( dst ), w ) );
+        }
+    }
+}
+
+// Write a g to output in adjacency matrix form.
+void write_adjacency_matrix( std::ostream& output, adjacency_list const& g )
+{
+    for ( vertex_id u = 0; u < count_vertices( g ); ++u )
+    {
+        for ( vertex_id v = 0; v < count_vertices( g ); ++v )
+            output << (std::binary_search( g[u].begin(), g[u].end(), v ) ? "* " : ". ");
+        output << std::endl;
+    }
+}
+
+// Return the number of microseconds taken by bfs( g, u, v )
+double time_bfs( adjacency_list const& g, vertex_id u, vertex_id v, bool& found )
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    found = bfs( g, u, v );
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start ).count();
+}
+
+// Time bfs( a, au, av ) and bfs( b, bu, bv ), repeats times each,
+// setting ta and tb to the fastest run of each.  Both are run once
+// untimed first, and the two alternate in which goes first, so
+// neither is measured cold or always right after the other.
+void compare_bfs(
+    adjacency_list const& a, vertex_id au, vertex_id av,
+    adjacency_list const& b, vertex_id bu, vertex_id bv,
+    unsigned repeats, double& ta, double& tb, bool& found_a, bool& found_b )
+{
+    found_a = bfs( a, au, av );
+    found_b = bfs( b, bu, bv );
+    ta = tb = std::numeric_limits<double>::infinity();
+    for ( unsigned r = 0; r < repeats; ++r )
+    {
+        if ( r % 2 == 0 )
+        {
+            ta = std::min( ta, time_bfs( a, au, av, found_a ) );
+            tb = std::min( tb, time_bfs( b, bu, bv, found_b ) );
+        }
+        else
+        {
+            tb = std::min( tb, time_bfs( b, bu, bv, found_b ) );
+            ta = std::min( ta, time_bfs( a, au, av, found_a ) );
+        }
+    }
+}
+
+#include <iostream>
+int main( int argc, char *argv[] )
+{
+    graph wg;
+    read_adjacency_list( std::cin, wg );
+
+    adjacency_list g = make_adjacency_list( wg );
+    write_adjacency_matrix( std::cout, g );
+
+    if ( argc < 2 )
+        return 0;
+
+    std::string name = argv[1];
+    permutation perm = vertex_order( g, name );
+    adjacency_list reordered = relabel( g, perm );
+
+    std::cout << name << " order, old -> new: ";
+    for ( vertex_id u = 0; u < perm.size(); ++u )
+        std::cout << u << "->" << perm[u] << " ";
+    std::cout << std::endl;
+    write_adjacency_matrix( std::cout, reordered );
+
+    if ( argc == 4 )
+    {
+        vertex_id u, v;
+        std::stringstream(argv[2]) >> u;
+        std::stringstream(argv[3]) >> v;
+
+        // Queries on the reordered graph use translated ids
+        unsigned const repeats = 9;
+        bool found, reordered_found;
+        double t0, t1;
+        compare_bfs( g, u, v, reordered, perm[u], perm[v], repeats, t0, t1, found, reordered_found );
+        assert( found == reordered_found );
+
+        std::cout << "vertex " << v << " is " << (found ? "" : "not ")
+                  << "reachable from vertex " << u << std::endl;
+        std::cout << "original bfs: " << t0 << " us, reordered bfs: " << t1 << " us (best of "
+                  << repeats << ")" << std::endl;
+    }
+}